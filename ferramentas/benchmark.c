@@ -0,0 +1,309 @@
+/*============================================================================
+ * MICRO-BENCHMARKS DOS KERNELS DO FIRMWARE
+ * Mede regressão linear (várias janelas), atualização Holt, filtro de
+ * discrepantes, pipeline de previsão (uma sonda e várias, em estrutura de
+ * vetores contra um Previsor_t por canal), primitivas do SSD1306, gráfico de
+ * tendência, matriz WS2812 e formatação dos payloads MQTT. No PC usa o
+ * relógio monotônico; no Pico usa time_us_64 e o SysTick (ciclos de clk_sys)
+ * e imprime pelo USB CDC.
+ *===========================================================================*/
+#include <stdio.h>
+#include <string.h>
+#include "previsao.h"
+#include "previsao_fixo.h"
+#include "previsao_multicanal.h"
+#include "hampel.h"
+#include "ssd1306.h"
+#include "tendencia.h"
+#include "matriz_led.h"
+
+#if BENCHMARK_HOST
+#include <time.h>
+#else
+#include "pico/stdio_usb.h"
+#include "hardware/i2c.h"
+#include "hardware/structs/systick.h"
+#endif
+
+#define RODADAS             5       // Repetições de cada kernel; reporta mínimo e mediana
+#define TEMPO_ALVO_NS       20000000ull // Duração mínima de uma rodada após calibração
+#define JANELA_MAXIMA       120     // Maior janela medida na regressão
+#define CANAIS_MAXIMO       64      // Mais canais medidos no previsor multicanal (PREVISAO_CANAIS_MAX do alvo)
+#define MQTT_TOPIC_BASE     "/Temperatura_MQTT_Pico" // Mesmo tópico base de main.c
+#define PINO_SDA_I2C        14      // Mesmos pinos do display em main.c
+#define PINO_SCL_I2C        15
+
+/*============================================================================
+ * RELÓGIO
+ *===========================================================================*/
+#if BENCHMARK_HOST
+static uint64_t agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+#else
+static uint64_t agora_ns(void) {
+    return time_us_64() * 1000;
+}
+
+// SysTick conta para baixo em 24 bits a partir de clk_sys
+static inline uint32_t ciclos_systick(void) {
+    return systick_hw->cvr;
+}
+#endif
+
+/*============================================================================
+ * DADOS DOS KERNELS
+ *===========================================================================*/
+static float tempos[JANELA_MAXIMA], temperaturas[JANELA_MAXIMA];
+static int janela_atual;
+static Previsor_t previsor;
+static PrevisorFixo_t previsor_fixo;
+static PrevisorMulticanal_t previsor_multicanal;
+static Previsor_t previsores_canais[CANAIS_MAXIMO]; // Referência: um previsor independente por canal
+static float leituras_canais[CANAIS_MAXIMO];
+static int canais_atual;
+static FiltroHampel_t filtro_hampel;
+static ssd1306_t display;
+static GraficoTendencia_t grafico;
+static volatile float sumidouro; // Impede que o compilador descarte os resultados
+
+static void kernel_regressao(void) {
+    float m, b;
+    calcular_regressao(tempos, temperaturas, janela_atual, &m, &b);
+    sumidouro = m + b;
+}
+
+static void kernel_holt(void) {
+    float previsoes[NUM_HORIZONTES], margens[NUM_HORIZONTES];
+    previsao_atualizar_holt(&previsor, 25.0f, 1.0f, previsoes, margens);
+    sumidouro = previsoes[HORIZONTE_PADRAO];
+}
+
+static void kernel_hampel(void) {
+    static int i;
+    int16_t saida;
+    hampel_filtrar(&filtro_hampel, (int16_t)(400 + i++ % 5), &saida); // Janela cheia: caso permanente
+    sumidouro = saida;
+}
+
+static void kernel_pipeline(void) {
+    static float tempo;
+    float filtrada;
+    ResultadosPrevisao_t resultados;
+    previsao_processar(&previsor, 25.0f + (int)tempo % 7 * 0.0625f, tempo, &filtrada, &resultados);
+    tempo += 5;
+    sumidouro = resultados.previsao_linear[HORIZONTE_PADRAO];
+}
+
+static void kernel_pipeline_fixo(void) {
+    static uint32_t tempo_ms;
+    q16_t filtrada;
+    ResultadosPrevisao_t resultados;
+    previsao_fixo_processar(&previsor_fixo, (int16_t)(400 + tempo_ms / 5000 % 7), tempo_ms, &filtrada, &resultados);
+    tempo_ms += 5000;
+    sumidouro = resultados.previsao_linear[HORIZONTE_PADRAO];
+}
+
+// Próxima leitura de cada canal: rampas com inclinações diferentes e variação de um LSB
+static float avancar_leituras(void) {
+    static int passo;
+    for (int c = 0; c < canais_atual; c++) leituras_canais[c] = 20.0f + c * 0.25f + (passo + c) % 7 * 0.0625f;
+    return passo++ * 5.0f;
+}
+
+static void kernel_multicanal(void) {
+    float tempo = avancar_leituras();
+    previsao_multicanal_atualizar(&previsor_multicanal, leituras_canais, tempo);
+    sumidouro = previsor_multicanal.niveis[canais_atual - 1];
+}
+
+static void kernel_previsores_canais(void) {
+    float tempo = avancar_leituras(), filtrada;
+    ResultadosPrevisao_t resultados;
+    for (int c = 0; c < canais_atual; c++) {
+        previsao_processar(&previsores_canais[c], leituras_canais[c], tempo, &filtrada, &resultados);
+    }
+    sumidouro = resultados.nivel_holt;
+}
+
+static void kernel_fill(void) {
+    ssd1306_fill(&display, false);
+}
+
+static void kernel_draw_string(void) {
+    ssd1306_draw_string(&display, "Temp: 23.5C", 0, 20, false);
+}
+
+static void kernel_send_data(void) {
+    ssd1306_send_data(&display);
+}
+
+// Ponto novo no gráfico de tendência: rola uma coluna e rasteriza a última (escala estável)
+static void kernel_tendencia_adicionar(void) {
+    static int i;
+    tendencia_adicionar(&grafico, 22.0f + (i++ % 8) * 0.1f, 30);
+}
+
+static void kernel_tendencia_desenhar(void) {
+    static const ExtensaoTendencia_t extensao = { 22.4f, 0.002f, 22.4f, 0.003f, 5.0f };
+    tendencia_desenhar(&grafico, &display, 30, &extensao);
+}
+
+// Referência: o mesmo gráfico redesenhado ponto a ponto com ssd1306_line
+static void kernel_tendencia_linhas(void) {
+    int anterior = 0;
+    for (int x = 0; x < TENDENCIA_COLUNAS; x++) {
+        int y = 8 + (x % 8) * 7;
+        if (x) ssd1306_line(&display, x - 1, anterior, x, y, true);
+        anterior = y;
+    }
+}
+
+static void kernel_matriz(void) {
+    matriz_draw_pattern(PAD_EXC, COR_AMARELO);
+}
+
+// Tópicos de valor único da publicação periódica de tarefa_publicar_mqtt, no mesmo formato
+static void kernel_payload_mqtt(void) {
+    static const char *const sufixos[] = { "/temperatura", "/temperatura_previsao_regressao_linear",
+                                           "/temperatura_previsao_holt", "/estado", "/ponto_de_regulagem" };
+    char topico[100], buffer[16];
+    float valores[3] = { 23.5625f, 27.1875f, 26.9375f };
+    size_t total = 0;
+    for (int i = 0; i < 5; i++) {
+        snprintf(topico, sizeof(topico), MQTT_TOPIC_BASE "%s", sufixos[i]);
+        if (i < 3) snprintf(buffer, sizeof(buffer), "%.2f", valores[i]);
+        else if (i == 3) snprintf(buffer, sizeof(buffer), "%s", "Normal");
+        else snprintf(buffer, sizeof(buffer), "%d", 30);
+        total += strlen(topico) + strlen(buffer);
+    }
+    sumidouro = (float)total;
+}
+
+/*============================================================================
+ * MEDIÇÃO
+ *===========================================================================*/
+static uint64_t rodar(void (*kernel)(void), uint32_t iteracoes) {
+    uint64_t inicio = agora_ns();
+    for (uint32_t i = 0; i < iteracoes; i++) kernel();
+    return agora_ns() - inicio;
+}
+
+static void medir(const char *nome, void (*kernel)(void)) {
+    // Dobra as iterações até uma rodada durar TEMPO_ALVO_NS
+    uint32_t iteracoes = 1;
+    kernel(); // Aquece caches e inicializa estados
+    while (rodar(kernel, iteracoes) < TEMPO_ALVO_NS && iteracoes < (1u << 30)) iteracoes *= 2;
+
+    double ns_por_op[RODADAS];
+    for (int r = 0; r < RODADAS; r++) {
+        double valor = (double)rodar(kernel, iteracoes) / iteracoes;
+        int i = r;
+        for (; i > 0 && ns_por_op[i - 1] > valor; i--) ns_por_op[i] = ns_por_op[i - 1]; // Inserção ordenada
+        ns_por_op[i] = valor;
+    }
+
+#if BENCHMARK_HOST
+    printf("%-26s %10lu %12.1f %12.1f %12s\n", nome, (unsigned long)iteracoes, ns_por_op[0], ns_por_op[RODADAS / 2], "-");
+#else
+    // Menor custo de uma chamada isolada em ciclos; só cabe no SysTick abaixo de 2^24 ciclos
+    uint32_t minimo = UINT32_MAX;
+    if (ns_por_op[0] < 100000000.0) {
+        for (int r = 0; r < 16; r++) {
+            uint32_t antes = ciclos_systick();
+            kernel();
+            uint32_t decorridos = (antes - ciclos_systick()) & 0x00FFFFFF;
+            if (decorridos < minimo) minimo = decorridos;
+        }
+    }
+    char ciclos[16] = "-";
+    if (minimo != UINT32_MAX) snprintf(ciclos, sizeof(ciclos), "%lu", (unsigned long)minimo);
+    printf("%-26s %10lu %12.1f %12.1f %12s\n", nome, (unsigned long)iteracoes, ns_por_op[0], ns_por_op[RODADAS / 2], ciclos);
+#endif
+}
+
+static void executar_suite(void) {
+    static const int janelas[] = { 8, 30, 64, JANELA_MAXIMA };
+    char nome[32];
+    printf("%-26s %10s %12s %12s %12s\n", "kernel", "it/rodada", "ns/op(min)", "ns/op(med)", "ciclos(min)");
+    for (size_t i = 0; i < sizeof(janelas) / sizeof(janelas[0]); i++) {
+        janela_atual = janelas[i];
+        snprintf(nome, sizeof(nome), "calcular_regressao n=%d", janela_atual);
+        medir(nome, kernel_regressao);
+    }
+    medir("previsao_atualizar_holt", kernel_holt);
+    medir("hampel_filtrar", kernel_hampel);
+    medir("previsao_processar", kernel_pipeline);
+    medir("previsao_fixo_processar", kernel_pipeline_fixo);
+    static const int canais[] = { 1, 8, 32, CANAIS_MAXIMO };
+    ParametrosPrevisao_t parametros;
+    previsao_parametros_padrao(&parametros, 5.0f);
+    for (size_t i = 0; i < sizeof(canais) / sizeof(canais[0]); i++) {
+        canais_atual = canais[i];
+        previsao_multicanal_iniciar(&previsor_multicanal, &parametros, canais_atual);
+        for (int c = 0; c < canais_atual; c++) previsao_iniciar(&previsores_canais[c], &parametros);
+        snprintf(nome, sizeof(nome), "multicanal n=%d", canais_atual);
+        medir(nome, kernel_multicanal);
+        snprintf(nome, sizeof(nome), "previsao_processar x%d", canais_atual);
+        medir(nome, kernel_previsores_canais);
+    }
+    medir("ssd1306_fill", kernel_fill);
+    medir("ssd1306_draw_string", kernel_draw_string);
+    medir("ssd1306_send_data", kernel_send_data);
+    medir("tendencia_adicionar", kernel_tendencia_adicionar);
+    medir("tendencia_desenhar", kernel_tendencia_desenhar);
+    medir("tendencia via ssd1306_line", kernel_tendencia_linhas);
+    medir("matriz_draw_pattern", kernel_matriz);
+    medir("payload_mqtt (5 topicos)", kernel_payload_mqtt);
+}
+
+static void preparar_dados(void) {
+    ParametrosPrevisao_t parametros;
+    previsao_parametros_padrao(&parametros, 5.0f);
+    previsao_iniciar(&previsor, &parametros);
+    previsao_fixo_iniciar(&previsor_fixo, &parametros);
+    ParametrosHampel_t parametros_hampel;
+    hampel_parametros_padrao(&parametros_hampel);
+    hampel_iniciar(&filtro_hampel, &parametros_hampel);
+    tendencia_iniciar(&grafico);
+    // Rampa lenta com variação de um LSB do DS18B20, como um histórico real
+    for (int i = 0; i < JANELA_MAXIMA; i++) {
+        tempos[i] = i * 5.0f;
+        temperaturas[i] = 22.0f + i * 0.01f + (i % 3) * 0.0625f;
+    }
+}
+
+int main(void) {
+#if BENCHMARK_HOST
+    preparar_dados();
+    ssd1306_init(&display, 128, 64, false, 0x3C, i2c1);
+    inicializar_matriz_led();
+    executar_suite();
+    return 0;
+#else
+    stdio_init_all();
+    i2c_init(i2c1, 400 * 1000);
+    gpio_set_function(PINO_SDA_I2C, GPIO_FUNC_I2C);
+    gpio_set_function(PINO_SCL_I2C, GPIO_FUNC_I2C);
+    gpio_pull_up(PINO_SDA_I2C);
+    gpio_pull_up(PINO_SCL_I2C);
+    ssd1306_init(&display, 128, 64, false, 0x3C, i2c1);
+    ssd1306_config(&display);
+    inicializar_matriz_led();
+    preparar_dados();
+
+    // SysTick livre em 24 bits no clock do processador, sem interrupção
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;
+
+    while (!stdio_usb_connected()) sleep_ms(100); // Espera o terminal abrir a porta CDC
+    while (1) {
+        executar_suite();
+        printf("\n");
+        sleep_ms(10000);
+    }
+#endif
+}
@@ -0,0 +1,13 @@
+// I2C do host: só contabiliza os bytes que iriam para o barramento
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *i2c1;
+extern volatile size_t host_bytes_i2c;  // Total de bytes "transmitidos"
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif /* HOST_HARDWARE_I2C_H */
@@ -0,0 +1,34 @@
+// PIO do host: aceita o programa do WS2812 e guarda o último pixel enviado
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+typedef struct pio_inst *PIO;
+typedef struct { uint32_t clkdiv, execctrl, shiftctrl, pinctrl; } pio_sm_config;
+struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+};
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE, PIO_FIFO_JOIN_TX, PIO_FIFO_JOIN_RX };
+
+extern PIO pio0;
+extern volatile uint32_t host_ultimo_pixel_pio;
+
+static inline void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) { (void)pio; (void)sm; host_ultimo_pixel_pio = data; }
+static inline uint pio_add_program(PIO pio, const struct pio_program *program) { (void)pio; (void)program; return 0; }
+static inline pio_sm_config pio_get_default_sm_config(void) { pio_sm_config c = {0}; return c; }
+static inline void sm_config_set_wrap(pio_sm_config *c, uint target, uint wrap) { (void)c; (void)target; (void)wrap; }
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bits, bool optional, bool pindirs) { (void)c; (void)bits; (void)optional; (void)pindirs; }
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint pin) { (void)c; (void)pin; }
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool right, bool autopull, uint threshold) { (void)c; (void)right; (void)autopull; (void)threshold; }
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { (void)c; (void)join; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { (void)c; (void)div; }
+static inline void pio_gpio_init(PIO pio, uint pin) { (void)pio; (void)pin; }
+static inline void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool out) { (void)pio; (void)sm; (void)pin; (void)count; (void)out; }
+static inline void pio_sm_init(PIO pio, uint sm, uint offset, const pio_sm_config *c) { (void)pio; (void)sm; (void)offset; (void)c; }
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) { (void)pio; (void)sm; (void)enabled; }
+
+#endif /* HOST_HARDWARE_PIO_H */
@@ -0,0 +1,14 @@
+// Substituto mínimo do Pico SDK para compilar as bibliotecas do firmware no PC
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+static inline void sleep_us(uint64_t us) { (void)us; } // Sem hardware para esperar
+static inline void sleep_ms(uint32_t ms) { (void)ms; }
+
+#endif /* HOST_PICO_STDLIB_H */
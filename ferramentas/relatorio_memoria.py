@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Relatório de RAM por subsistema a partir do .map do GNU ld.
+
+Soma as seções de entrada que caem na RAM do RP2040 (0x20000000-0x20042000, incluindo os
+bancos SCRATCH_X/Y) e as atribui a um subsistema pelo arquivo objeto de origem. Os objetos
+estáticos do RTOS em main.c (PERFIL_ESTATICO) são separados pelo prefixo do símbolo.
+
+Uso: relatorio_memoria.py PicoMQTT.elf.map [--orcamento BYTES] [--limite Nome=BYTES ...]
+Sai com código 1 se o total ou algum subsistema passar do limite.
+"""
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+RAM_INICIO = 0x20000000
+RAM_FIM = 0x20042000
+
+# Seção de entrada: " .bss.nome   0x20001000   0x40 arquivo.obj"; nomes longos quebram a linha
+ENTRADA = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.+))?$")
+SO_NOME = re.compile(r"^ (\S+)$")
+CONTINUACAO = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.+))?$")
+PREENCHIMENTO = re.compile(r"^ \*fill\*\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+SAIDA = re.compile(r"^(\.\S+)")
+
+SUBSISTEMAS = [
+    # (nome, padrão no caminho do objeto), na ordem de verificação
+    ("Heap FreeRTOS", re.compile(r"FreeRTOS.*heap_\d")),
+    ("FreeRTOS", re.compile(r"FreeRTOS")),
+    ("lwIP", re.compile(r"lwip", re.I)),
+    ("mbedTLS", re.compile(r"mbedtls", re.I)),
+    ("cyw43", re.compile(r"cyw43", re.I)),
+    ("newlib/libgcc", re.compile(r"lib(c|m|g|gcc|nosys|stdc\+\+)(_nano)?\.a|crt\w*\.o")),
+]
+LIB_PROJETO = re.compile(r"PicoMQTT\.dir/lib/([^/]+)/")
+
+# Símbolos de main.c criados pelas macros CRIAR_* (PERFIL_ESTATICO)
+SIMBOLOS_MAIN = [
+    ("Tarefas (pilhas e TCBs)", re.compile(r"\.(pilha|tcb)_")),
+    ("Filas, mutexes e timers", re.compile(r"\.(armazenamento|controle)_")),
+    ("lib/Display_Bibliotecas", re.compile(r"\.buffer_display")),
+]
+
+
+def subsistema(secao_saida, secao, objeto):
+    if secao_saida.startswith((".stack", ".heap")) or secao.startswith(".stack"):
+        return "Pilhas de boot/heap newlib"
+    if objeto is None:
+        return "Outros"
+    if "main.c" in objeto:
+        for nome, padrao in SIMBOLOS_MAIN:
+            if padrao.search(secao):
+                return nome
+        return "Aplicação (main.c)"
+    for nome, padrao in SUBSISTEMAS:
+        if padrao.search(objeto):
+            return nome
+    achado = LIB_PROJETO.search(objeto)
+    if achado:
+        return "lib/" + achado.group(1)
+    return "Pico SDK"
+
+
+def ler_mapa(caminho):
+    totais = defaultdict(int)
+    secao_saida = ""
+    pendente = None  # Nome de seção cuja linha de endereço vem a seguir
+    dentro = False
+    with open(caminho, encoding="utf-8", errors="replace") as arquivo:
+        for linha in arquivo:
+            linha = linha.rstrip("\n")
+            if not dentro:
+                dentro = linha.startswith("Linker script and memory map")
+                continue
+            if linha.startswith(("/DISCARD/", "OUTPUT(")):
+                break
+            saida = SAIDA.match(linha)
+            if saida:
+                secao_saida = saida.group(1)
+                pendente = None
+                continue
+            preenchimento = PREENCHIMENTO.match(linha)
+            if preenchimento:
+                endereco, tamanho = int(preenchimento.group(1), 16), int(preenchimento.group(2), 16)
+                if RAM_INICIO <= endereco < RAM_FIM:
+                    totais["Alinhamento"] += tamanho
+                continue
+            if pendente is not None:
+                continuacao = CONTINUACAO.match(linha)
+                secao, pendente = pendente, None
+                if continuacao:
+                    registrar(totais, secao_saida, secao, int(continuacao.group(1), 16),
+                              int(continuacao.group(2), 16), continuacao.group(3))
+                    continue
+            entrada = ENTRADA.match(linha)
+            if entrada:
+                registrar(totais, secao_saida, entrada.group(1), int(entrada.group(2), 16),
+                          int(entrada.group(3), 16), entrada.group(4))
+                continue
+            so_nome = SO_NOME.match(linha)
+            if so_nome and not so_nome.group(1).startswith("*"):
+                pendente = so_nome.group(1)
+    return totais
+
+
+def registrar(totais, secao_saida, secao, endereco, tamanho, objeto):
+    if tamanho and RAM_INICIO <= endereco < RAM_FIM:
+        totais[subsistema(secao_saida, secao, objeto)] += tamanho
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("mapa")
+    parser.add_argument("--orcamento", type=int, default=0, help="máximo total em bytes (0 = sem limite)")
+    parser.add_argument("--limite", action="append", default=[], metavar="NOME=BYTES",
+                        help="máximo de um subsistema; pode repetir")
+    args = parser.parse_args()
+
+    try:
+        totais = ler_mapa(args.mapa)
+    except OSError as erro:
+        print(f"relatorio_memoria: {erro}", file=sys.stderr)
+        return 1
+    total = sum(totais.values())
+
+    print(f"{'Subsistema':<28}{'Bytes':>10}{'%':>7}")
+    for nome, bytes_ in sorted(totais.items(), key=lambda item: -item[1]):
+        print(f"{nome:<28}{bytes_:>10}{100.0 * bytes_ / max(total, 1):>6.1f}%")
+    print(f"{'Total':<28}{total:>10}  de {RAM_FIM - RAM_INICIO} na RAM")
+
+    estourou = False
+    for limite in args.limite:
+        nome, _, valor = limite.partition("=")
+        if not valor.isdigit():
+            print(f"relatorio_memoria: limite inválido '{limite}'", file=sys.stderr)
+            return 1
+        if totais.get(nome, 0) > int(valor):
+            print(f"ERRO: {nome} usa {totais[nome]} bytes, limite {valor}", file=sys.stderr)
+            estourou = True
+    if args.orcamento and total > args.orcamento:
+        print(f"ERRO: RAM estática de {total} bytes passa do orçamento de {args.orcamento}", file=sys.stderr)
+        estourou = True
+    return 1 if estourou else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,535 @@
+/*============================================================================
+ * SIMULADOR DE PREVISÃO (HOST)
+ * Reproduz traços de temperatura gravados pelo mesmo pipeline do firmware
+ * (Hampel -> filtro -> histórico -> regressão linear / Holt -> máquina de alerta) em
+ * tempo virtual, medindo vazão, erro e cobertura dos intervalos das previsões,
+ * erro do tempo até a urgência e a linha do tempo dos alertas. Aceita varreduras de parâmetros no formato inicio:fim:passo.
+ *===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "previsao.h"
+#include "previsao_fixo.h"
+#include "previsao_multicanal.h"
+#include "calibracao.h"
+#include "hampel.h"
+#include "alerta.h"
+
+#define URGENCIA_PADRAO   30    // Temperatura de urgência padrão do firmware (°C)
+#define INTERVALO_PADRAO  5.0f  // Período entre leituras do firmware (s)
+#define TOLERANCIA_PADRAO 0.05f // Diferença máxima aceita entre ponto fixo e float (°C)
+#define CANAIS_EQUIVALENCIA 8   // Canais do previsor multicanal comparados com um Previsor_t cada
+
+/* ---------- Traço ---------- */
+typedef struct {
+    float *tempo;        // Instante de cada leitura (s)
+    float *temperatura;  // Leitura bruta (°C)
+    size_t n;
+} Traco_t;
+
+/* ---------- Faixa de varredura de um parâmetro ---------- */
+typedef struct {
+    float inicio, fim, passo;
+} Faixa_t;
+
+/* ---------- Resultado de uma execução ---------- */
+typedef struct {
+    double amostras_por_s;
+    double eam_linear[NUM_HORIZONTES], reqm_linear[NUM_HORIZONTES]; // Erro absoluto médio e raiz do erro quadrático médio
+    double eam_holt[NUM_HORIZONTES], reqm_holt[NUM_HORIZONTES];
+    double cobertura_linear[NUM_HORIZONTES], cobertura_holt[NUM_HORIZONTES]; // Fração dos reais dentro do intervalo
+    size_t comparacoes[NUM_HORIZONTES]; // Previsões cujo alvo caiu dentro do traço
+    ContadoresHampel_t rejeicoes;
+    double eam_eta_linear, eam_eta_holt;    // Erro do tempo até a urgência contra o cruzamento real (s)
+    size_t estimativas_eta_linear, estimativas_eta_holt;
+    int transicoes;
+    double segundos_por_nivel[NUM_NIVEIS_ALERTA];
+    NivelAlerta_t *niveis;           // Nível após cada leitura (liberado pelo chamador)
+} Resultado_t;
+
+static void uso(const char *programa) {
+    fprintf(stderr,
+            "Uso: %s [opções] traço\n"
+            "  -f csv|bin  formato do traço (padrão: pela extensão, .bin = binário)\n"
+            "  -a A        ALPHA_HOLT (padrão %.2f)\n"
+            "  -b B        BETA_HOLT (padrão %.2f)\n"
+            "  -n N        TAMANHO_HISTORICO_TEMP (padrão %d, máximo %d)\n"
+            "  -p S        INTERVALO_PREVISAO_SEGUNDOS, horizonte das colunas de erro (padrão %d)\n"
+            "  -H a,b,c,d  os %d horizontes calculados (s); -p substitui o de índice %d\n"
+            "  -i S        intervalo entre leituras quando o traço não tem tempo (padrão %.0f s)\n"
+            "  -u U        temperatura de urgência (padrão %d °C)\n"
+            "  -w W        janela do filtro de discrepantes (padrão %d, 0 desliga)\n"
+            "  -k K        limiar do filtro em desvios robustos (padrão %.1f)\n"
+            "  -l          imprime a linha do tempo dos alertas também nas varreduras\n"
+            "  -C          sem a calibração da margem da regressão (lib/Previsao/calibracao.c)\n"
+            "  -e          compara o caminho em ponto fixo (PREVISAO_PONTO_FIXO) com o float e cada\n"
+            "              canal do previsor multicanal com previsao_processar (qualquer diferença falha)\n"
+            "  -t T        tolerância da comparação (padrão %.2f °C); sai com erro se excedida\n"
+            "Valores de -a, -b, -n e -p aceitam varredura no formato inicio:fim:passo.\n"
+            "CSV: uma leitura por linha, \"tempo_s,temperatura\" ou só \"temperatura\".\n"
+            "Binário: pares de float32 little-endian (tempo_s, temperatura).\n",
+            programa, ALPHA_HOLT, BETA_HOLT, TAMANHO_HISTORICO_TEMP, TAMANHO_HISTORICO_MAX,
+            INTERVALO_PREVISAO_SEGUNDOS, NUM_HORIZONTES, HORIZONTE_PADRAO, INTERVALO_PADRAO, URGENCIA_PADRAO,
+            HAMPEL_JANELA, HAMPEL_K, TOLERANCIA_PADRAO);
+}
+
+//Interpreta "v" ou "inicio:fim:passo"
+static int ler_faixa(const char *texto, Faixa_t *faixa) {
+    int campos = sscanf(texto, "%f:%f:%f", &faixa->inicio, &faixa->fim, &faixa->passo);
+    if (campos == 1) {
+        faixa->fim = faixa->inicio;
+        faixa->passo = 1;
+        return 0;
+    }
+    return (campos == 3 && faixa->passo > 0 && faixa->fim >= faixa->inicio) ? 0 : -1;
+}
+
+//Interpreta "a,b,c,d" com exatamente NUM_HORIZONTES valores positivos
+static int ler_horizontes(const char *texto, float horizontes[NUM_HORIZONTES]) {
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        char *fim;
+        horizontes[h] = strtof(texto, &fim);
+        if (fim == texto || horizontes[h] <= 0 || (*fim != (h == NUM_HORIZONTES - 1 ? '\0' : ','))) return -1;
+        texto = fim + 1;
+    }
+    return 0;
+}
+
+static int passos_faixa(const Faixa_t *faixa) {
+    return (int)floorf((faixa->fim - faixa->inicio) / faixa->passo + 1e-4f) + 1;
+}
+
+static void traco_adicionar(Traco_t *traco, size_t *capacidade, float tempo, float temperatura) {
+    if (traco->n == *capacidade) {
+        *capacidade = *capacidade ? *capacidade * 2 : 1024;
+        traco->tempo = realloc(traco->tempo, *capacidade * sizeof(float));
+        traco->temperatura = realloc(traco->temperatura, *capacidade * sizeof(float));
+        if (!traco->tempo || !traco->temperatura) {
+            fprintf(stderr, "Memória insuficiente para o traço\n");
+            exit(1);
+        }
+    }
+    traco->tempo[traco->n] = tempo;
+    traco->temperatura[traco->n] = temperatura;
+    traco->n++;
+}
+
+//Lê o traço; leituras sem tempo recebem instantes múltiplos de intervalo_s
+static int carregar_traco(const char *caminho, int binario, float intervalo_s, Traco_t *traco) {
+    FILE *arquivo = fopen(caminho, binario ? "rb" : "r");
+    if (!arquivo) {
+        perror(caminho);
+        return -1;
+    }
+    size_t capacidade = 0;
+    if (binario) {
+        float registro[2];
+        while (fread(registro, sizeof(float), 2, arquivo) == 2) {
+            traco_adicionar(traco, &capacidade, registro[0], registro[1]);
+        }
+    } else {
+        char linha[128];
+        while (fgets(linha, sizeof(linha), arquivo)) {
+            float a, b;
+            int campos = sscanf(linha, "%f%*[,; \t]%f", &a, &b);
+            if (campos == 2) traco_adicionar(traco, &capacidade, a, b);
+            else if (campos == 1) traco_adicionar(traco, &capacidade, traco->n * intervalo_s, a);
+            // Cabeçalhos e comentários não têm número no início e são ignorados
+        }
+    }
+    fclose(arquivo);
+    return traco->n >= 2 ? 0 : -1;
+}
+
+//Temperatura do traço no instante t por interpolação linear (tempos crescentes)
+static float temperatura_em(const Traco_t *traco, float t) {
+    size_t baixo = 0, alto = traco->n - 1;
+    while (alto - baixo > 1) {
+        size_t meio = (baixo + alto) / 2;
+        if (traco->tempo[meio] <= t) baixo = meio;
+        else alto = meio;
+    }
+    float dt = traco->tempo[alto] - traco->tempo[baixo];
+    if (dt <= 0) return traco->temperatura[baixo];
+    float fracao = (t - traco->tempo[baixo]) / dt;
+    return traco->temperatura[baixo] + fracao * (traco->temperatura[alto] - traco->temperatura[baixo]);
+}
+
+//Leitura bruta do DS18B20 (1/16 °C) que o firmware entregaria após o filtro de discrepantes.
+//Retorna false se a leitura for descartada; sem filtro, só quantiza
+static bool ler_bruto(FiltroHampel_t *filtro, float temperatura, int16_t *bruto) {
+    *bruto = (int16_t)lroundf(temperatura * 16);
+    return !filtro || hampel_filtrar(filtro, *bruto, bruto) != HAMPEL_DESCARTADA;
+}
+
+//Roda o pipeline sobre o traço inteiro em tempo virtual
+static void simular(const Traco_t *traco, const ParametrosPrevisao_t *parametros, const ParametrosHampel_t *parametros_hampel,
+                    int urgencia, int calibrar, Resultado_t *resultado) {
+    static Previsor_t previsor;
+    static FiltroHampel_t filtro;
+    static CalibracaoLinear_t calibracao;
+    ResultadosPrevisao_t *previsoes = malloc(traco->n * sizeof(*previsoes));
+    unsigned char *valida = malloc(traco->n);
+    MaquinaAlerta_t maquina;
+    NivelAlerta_t nivel = NIVEL_NORMAL;
+    float inicio_nivel = traco->tempo[0];
+    NivelAlerta_t *niveis = malloc(traco->n * sizeof(*niveis));
+    memset(resultado, 0, sizeof(*resultado));
+    previsao_iniciar(&previsor, parametros);
+    calibracao_iniciar(&calibracao, parametros);
+    if (parametros_hampel) hampel_iniciar(&filtro, parametros_hampel);
+    alerta_iniciar(&maquina, (uint32_t)(traco->tempo[0] * 1000));
+
+    // Só o pipeline entra na medida de vazão
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t i = 0; i < traco->n; i++) {
+        float temp_filtrada;
+        int16_t bruto;
+        valida[i] = ler_bruto(parametros_hampel ? &filtro : NULL, traco->temperatura[i], &bruto) &&
+                    previsao_processar(&previsor, bruto * 0.0625f, traco->tempo[i], &temp_filtrada, &previsoes[i]);
+        if (valida[i] && calibrar) calibracao_aplicar(&calibracao, parametros, traco->tempo[i], bruto * 0.0625f, &previsoes[i]);
+        niveis[i] = valida[i] ? alerta_atualizar(&maquina, temp_filtrada, &previsoes[i], urgencia,
+                                                 (uint32_t)(traco->tempo[i] * 1000))
+                              : maquina.nivel;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double segundos = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    resultado->amostras_por_s = segundos > 0 ? traco->n / segundos : INFINITY;
+    if (parametros_hampel) resultado->rejeicoes = filtro.contadores;
+
+    // Erro de cada previsão contra o traço bruto no instante alvo, por horizonte
+    float fim = traco->tempo[traco->n - 1];
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        for (size_t i = 0; i < traco->n; i++) {
+            float alvo = traco->tempo[i] + parametros->horizontes_s[h];
+            if (!valida[i] || alvo > fim) continue;
+            double real = temperatura_em(traco, alvo);
+            double erro_linear = previsoes[i].previsao_linear[h] - real;
+            double erro_holt = previsoes[i].previsao_holt[h] - real;
+            resultado->eam_linear[h] += fabs(erro_linear);
+            resultado->reqm_linear[h] += erro_linear * erro_linear;
+            resultado->eam_holt[h] += fabs(erro_holt);
+            resultado->reqm_holt[h] += erro_holt * erro_holt;
+            resultado->cobertura_linear[h] += fabs(erro_linear) <= previsoes[i].margem_linear[h];
+            resultado->cobertura_holt[h] += fabs(erro_holt) <= previsoes[i].margem_holt[h];
+            resultado->comparacoes[h]++;
+        }
+        if (resultado->comparacoes[h]) {
+            resultado->eam_linear[h] /= resultado->comparacoes[h];
+            resultado->eam_holt[h] /= resultado->comparacoes[h];
+            resultado->reqm_linear[h] = sqrt(resultado->reqm_linear[h] / resultado->comparacoes[h]);
+            resultado->reqm_holt[h] = sqrt(resultado->reqm_holt[h] / resultado->comparacoes[h]);
+            resultado->cobertura_linear[h] /= resultado->comparacoes[h];
+            resultado->cobertura_holt[h] /= resultado->comparacoes[h];
+        }
+    }
+
+    // Tempo até a urgência contra o próximo instante em que o traço bruto a alcança
+    float proximo_cruzamento = -1;
+    for (size_t i = traco->n; i-- > 0;) {
+        if (traco->temperatura[i] >= urgencia) proximo_cruzamento = traco->tempo[i];
+        if (!valida[i] || proximo_cruzamento < 0) continue;
+        float real = proximo_cruzamento - traco->tempo[i];
+        float eta_linear = previsao_tempo_ate_limite(previsoes[i].nivel_linear, previsoes[i].inclinacao_linear, urgencia);
+        float eta_holt = previsao_tempo_ate_limite(previsoes[i].nivel_holt, previsoes[i].inclinacao_holt, urgencia);
+        if (eta_linear >= 0) {
+            resultado->eam_eta_linear += fabs(eta_linear - real);
+            resultado->estimativas_eta_linear++;
+        }
+        if (eta_holt >= 0) {
+            resultado->eam_eta_holt += fabs(eta_holt - real);
+            resultado->estimativas_eta_holt++;
+        }
+    }
+    if (resultado->estimativas_eta_linear) resultado->eam_eta_linear /= resultado->estimativas_eta_linear;
+    if (resultado->estimativas_eta_holt) resultado->eam_eta_holt /= resultado->estimativas_eta_holt;
+
+    // Transições e tempo acumulado em cada nível
+    for (size_t i = 0; i < traco->n; i++) {
+        if (niveis[i] == nivel) continue;
+        resultado->segundos_por_nivel[nivel] += traco->tempo[i] - inicio_nivel;
+        nivel = niveis[i];
+        inicio_nivel = traco->tempo[i];
+        resultado->transicoes++;
+    }
+    resultado->segundos_por_nivel[nivel] += fim - inicio_nivel;
+    resultado->niveis = niveis;
+    free(valida);
+    free(previsoes);
+}
+
+//Imprime o erro de cada horizonte, cada mudança de nível com o instante virtual e a leitura que a causou
+static void imprimir_detalhes(const Traco_t *traco, const ParametrosPrevisao_t *parametros, const Resultado_t *resultado) {
+    printf("  cobertura nominal dos intervalos: %.0f%% (z = %.2f)\n",
+           100 * erf(parametros->z_intervalo / sqrt(2.0)), parametros->z_intervalo);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        printf("  horizonte %5.0fs: EAM lin %.3f  REQM lin %.3f  EAM holt %.3f  REQM holt %.3f  "
+               "cobertura lin %.0f%% holt %.0f%%  (%zu previsões)\n",
+               parametros->horizontes_s[h], resultado->eam_linear[h], resultado->reqm_linear[h],
+               resultado->eam_holt[h], resultado->reqm_holt[h], 100 * resultado->cobertura_linear[h],
+               100 * resultado->cobertura_holt[h], resultado->comparacoes[h]);
+    }
+    printf("  filtro de discrepantes: %u aceitas, %u trocadas pela mediana, %u de 85 C do power-on\n",
+           resultado->rejeicoes.aceitas, resultado->rejeicoes.discrepantes, resultado->rejeicoes.valor_reset);
+    printf("  tempo até a urgência: EAM lin %.0fs (%zu estimativas)  EAM holt %.0fs (%zu estimativas)\n",
+           resultado->eam_eta_linear, resultado->estimativas_eta_linear,
+           resultado->eam_eta_holt, resultado->estimativas_eta_holt);
+    NivelAlerta_t nivel = NIVEL_NORMAL;
+    for (size_t i = 0; i < traco->n; i++) {
+        if (resultado->niveis[i] == nivel) continue;
+        printf("  t=%9.1fs  %-8s -> %-8s  (temp %.2f C)\n", traco->tempo[i], ROTULOS_ALERTA_DISPLAY[nivel],
+               ROTULOS_ALERTA_DISPLAY[resultado->niveis[i]], traco->temperatura[i]);
+        nivel = resultado->niveis[i];
+    }
+    printf("  Tempo por nível:");
+    for (int n = 0; n < NUM_NIVEIS_ALERTA; n++) {
+        printf(" %s %.0fs", ROTULOS_ALERTA_DISPLAY[n], resultado->segundos_por_nivel[n]);
+    }
+    printf("\n");
+}
+
+/* ---------- Regressão de referência (double) ---------- */
+typedef struct {
+    bool   valida;              // Janela com ao menos 2 pontos e tempos distintos
+    double previsao, margem;
+} ReferenciaLinear_t;
+
+//Reta centrada em double sobre (x, y) avaliada em x0, com a mesma margem de prever_linear
+static ReferenciaLinear_t regressao_referencia(const double *x, const double *y, int n, double x0, double z) {
+    ReferenciaLinear_t referencia = { .valida = false };
+    double media_x = 0, media_y = 0, sxy = 0, sxx = 0, syy = 0;
+    for (int i = 0; i < n; i++) {
+        media_x += x[i] / n;
+        media_y += y[i] / n;
+    }
+    for (int i = 0; i < n; i++) {
+        double dx = x[i] - media_x, dy = y[i] - media_y;
+        sxy += dx * dy;
+        sxx += dx * dx;
+        syy += dy * dy;
+    }
+    if (n < 2 || sxx <= 0) return referencia;
+    double inclinacao = sxy / sxx, dx = x0 - media_x;
+    double variancia = n > 2 ? fmax(syy - inclinacao * sxy, 0) / (n - 2) : 0;
+    referencia.valida = true;
+    referencia.previsao = media_y + inclinacao * dx;
+    referencia.margem = z * sqrt(variancia * (1.0 + 1.0 / n + dx * dx / sxx));
+    return referencia;
+}
+
+//Referência sobre a janela do previsor float
+static ReferenciaLinear_t referencia_janela(const Previsor_t *previsor, double tempo_atual, float horizonte_s) {
+    static double x[TAMANHO_HISTORICO_MAX], y[TAMANHO_HISTORICO_MAX];
+    int n = previsor->historico_preenchido ? previsor->parametros.tamanho_historico : previsor->indice_historico;
+    for (int i = 0; i < n; i++) {
+        x[i] = previsor->historico_tempo[i];
+        y[i] = previsor->historico_temperatura[i];
+    }
+    return regressao_referencia(x, y, n, tempo_atual + horizonte_s, previsor->parametros.z_intervalo);
+}
+
+//Roda os caminhos float e Q16.16 sobre as mesmas leituras brutas e mede a maior divergência.
+//O ponto fixo conta o tempo em 1/16 s; com jitter nas marcas, isso muda a reta e os passos do
+//Holt extrapolados a 60 min em décimos de grau. Para medir só a aritmética, o float recebe os
+//mesmos instantes quantizados (o eixo do ponto fixo, que começa em 0). A linear (previsão e
+//margem) é julgada contra a referência em double sobre essa janela; filtro e Holt contra o float
+static int comparar_ponto_fixo(const Traco_t *traco, const ParametrosPrevisao_t *parametros,
+                               const ParametrosHampel_t *parametros_hampel, float tolerancia) {
+    enum { FILTRO, HOLT, LINEAR_FIXO, LINEAR_FLOAT, MARGEM_HOLT, MARGEM_LINEAR, MARGEM_LINEAR_FLOAT, NUM_COMPARACOES };
+    static const char *const nomes[NUM_COMPARACOES] = {
+        "filtro fixo x float", "holt fixo x float", "linear fixo x double", "linear float x double",
+        "margem holt fixo x float", "margem lin fixo x double", "margem lin float x double"
+    };
+    static Previsor_t previsor;
+    static PrevisorFixo_t previsor_fixo;
+    static FiltroHampel_t filtro;
+    if (parametros_hampel) hampel_iniciar(&filtro, parametros_hampel);
+    previsao_iniciar(&previsor, parametros);
+    previsao_fixo_iniciar(&previsor_fixo, parametros);
+    double maximo[NUM_COMPARACOES] = {0}, soma[NUM_COMPARACOES] = {0};
+    size_t comparacoes = 0, divergencias_validade = 0;
+    for (size_t i = 0; i < traco->n; i++) {
+        // O firmware entrega ao caminho float a mesma leitura bruta convertida para °C
+        int16_t bruto;
+        if (!ler_bruto(parametros_hampel ? &filtro : NULL, traco->temperatura[i], &bruto)) continue;
+        float filtrada;
+        q16_t filtrada_q16;
+        ResultadosPrevisao_t resultado, resultado_fixo;
+        bool valida_fixo = previsao_fixo_processar(&previsor_fixo, bruto, (uint32_t)lround(traco->tempo[i] * 1000.0),
+                                                   &filtrada_q16, &resultado_fixo);
+        int mais_recente = (previsor_fixo.indice_historico + previsor_fixo.tamanho_historico - 1) % previsor_fixo.tamanho_historico;
+        float tempo = (float)previsor_fixo.historico_tempo[mais_recente] / TEMPO_FIXO_POR_S;
+        bool valida = previsao_processar(&previsor, bruto * 0.0625f, tempo, &filtrada, &resultado);
+        if (valida != valida_fixo) divergencias_validade++;
+        if (!valida || !valida_fixo) continue;
+        for (int h = 0; h < NUM_HORIZONTES; h++) {
+            // Janela sem reta definida (menos de 2 pontos): os dois caminhos devolvem a leitura, sem referência
+            ReferenciaLinear_t referencia = referencia_janela(&previsor, tempo, parametros->horizontes_s[h]);
+            if (!referencia.valida) continue;
+            double diferencas[NUM_COMPARACOES] = {
+                [FILTRO] = fabs(Q16_PARA_FLOAT(filtrada_q16) - filtrada),
+                [HOLT] = fabs(resultado_fixo.previsao_holt[h] - resultado.previsao_holt[h]),
+                [LINEAR_FIXO] = fabs(resultado_fixo.previsao_linear[h] - referencia.previsao),
+                [LINEAR_FLOAT] = fabs(resultado.previsao_linear[h] - referencia.previsao),
+                [MARGEM_HOLT] = fabs(resultado_fixo.margem_holt[h] - resultado.margem_holt[h]),
+                [MARGEM_LINEAR] = fabs(resultado_fixo.margem_linear[h] - referencia.margem),
+                [MARGEM_LINEAR_FLOAT] = fabs(resultado.margem_linear[h] - referencia.margem),
+            };
+            for (int k = 0; k < NUM_COMPARACOES; k++) {
+                if (diferencas[k] > maximo[k]) maximo[k] = diferencas[k];
+                soma[k] += diferencas[k];
+            }
+            comparacoes++;
+        }
+    }
+    int aprovado = divergencias_validade == 0;
+    printf("Ponto fixo (%zu previsões em %d horizontes):\n", comparacoes, NUM_HORIZONTES);
+    for (int k = 0; k < NUM_COMPARACOES; k++) {
+        printf("  %-26s max %.5f C  media %.5f C\n", nomes[k], maximo[k], comparacoes ? soma[k] / comparacoes : 0);
+        if (k != LINEAR_FLOAT && k != MARGEM_LINEAR_FLOAT && maximo[k] > tolerancia) aprovado = 0; // O float é só informativo
+    }
+    if (divergencias_validade) printf("  %zu leituras com validação diferente\n", divergencias_validade);
+    printf("  %s (tolerância %.3f C)\n", aprovado ? "EQUIVALENTE" : "DIVERGENTE", tolerancia);
+    return aprovado ? 0 : 1;
+}
+
+//Passa o traço por CANAIS_EQUIVALENCIA canais do previsor multicanal (cada um deslocado de c/4 °C,
+//que ainda é múltiplo de 1/16 °C) e por um Previsor_t por canal. A estrutura de vetores faz as mesmas
+//contas na mesma ordem, então filtro, previsões e margens têm de ser iguais bit a bit
+static int comparar_multicanal(const Traco_t *traco, const ParametrosPrevisao_t *parametros) {
+    static PrevisorMulticanal_t multicanal;
+    static Previsor_t previsores[CANAIS_EQUIVALENCIA];
+    previsao_multicanal_iniciar(&multicanal, parametros, CANAIS_EQUIVALENCIA);
+    for (int c = 0; c < CANAIS_EQUIVALENCIA; c++) previsao_iniciar(&previsores[c], parametros);
+    size_t comparacoes = 0, diferencas[CANAIS_EQUIVALENCIA] = {0}, primeira[CANAIS_EQUIVALENCIA] = {0};
+    for (size_t i = 0; i < traco->n; i++) {
+        // Fora da faixa o multicanal repete a filtrada e o escalar descarta: só leituras válidas entram
+        int16_t bruto;
+        ler_bruto(NULL, traco->temperatura[i], &bruto);
+        float leituras[CANAIS_EQUIVALENCIA];
+        bool validas = true;
+        for (int c = 0; c < CANAIS_EQUIVALENCIA; c++) {
+            leituras[c] = bruto * 0.0625f + c * 0.25f;
+            validas &= leituras[c] > TEMPERATURA_VALIDA_MIN && leituras[c] < TEMPERATURA_VALIDA_MAX;
+        }
+        if (!validas) continue;
+        previsao_multicanal_atualizar(&multicanal, leituras, traco->tempo[i]);
+        for (int c = 0; c < CANAIS_EQUIVALENCIA; c++) {
+            float filtrada;
+            ResultadosPrevisao_t escalar, canal;
+            if (!previsao_processar(&previsores[c], leituras[c], traco->tempo[i], &filtrada, &escalar)) continue;
+            previsao_multicanal_resultados(&multicanal, c, &canal);
+            bool igual = memcmp(&escalar, &canal, sizeof(canal)) == 0 &&
+                         memcmp(&filtrada, &multicanal.filtrada[c], sizeof(filtrada)) == 0;
+            if (!igual && diferencas[c]++ == 0) primeira[c] = i;
+            comparacoes++;
+        }
+    }
+    int aprovado = comparacoes > 0;
+    printf("Multicanal (%d canais, %zu resultados contra previsao_processar):\n", CANAIS_EQUIVALENCIA, comparacoes);
+    for (int c = 0; c < CANAIS_EQUIVALENCIA; c++) {
+        if (!diferencas[c]) continue;
+        printf("  canal %d: %zu resultados diferentes, o primeiro na leitura %zu\n", c, diferencas[c], primeira[c]);
+        aprovado = 0;
+    }
+    printf("  %s (bit a bit)\n", aprovado ? "EQUIVALENTE" : "DIVERGENTE");
+    return aprovado ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    Faixa_t alpha = { ALPHA_HOLT, ALPHA_HOLT, 1 }, beta = { BETA_HOLT, BETA_HOLT, 1 };
+    Faixa_t janela = { TAMANHO_HISTORICO_TEMP, TAMANHO_HISTORICO_TEMP, 1 };
+    Faixa_t horizonte = { INTERVALO_PREVISAO_SEGUNDOS, INTERVALO_PREVISAO_SEGUNDOS, 1 };
+    float intervalo_s = INTERVALO_PADRAO;
+    float tolerancia = TOLERANCIA_PADRAO;
+    float horizontes[NUM_HORIZONTES] = HORIZONTES_PREVISAO_S;
+    ParametrosHampel_t hampel;
+    hampel_parametros_padrao(&hampel);
+    int urgencia = URGENCIA_PADRAO, binario = -1, linha_tempo = 0, equivalencia = 0, calibrar = 1, opcao;
+
+    while ((opcao = getopt(argc, argv, "f:a:b:n:p:H:i:u:w:k:lCet:h")) != -1) {
+        int erro = 0;
+        switch (opcao) {
+            case 'f': binario = strcmp(optarg, "bin") == 0; break;
+            case 'a': erro = ler_faixa(optarg, &alpha); break;
+            case 'b': erro = ler_faixa(optarg, &beta); break;
+            case 'n': erro = ler_faixa(optarg, &janela); break;
+            case 'p': erro = ler_faixa(optarg, &horizonte); break;
+            case 'H': erro = ler_horizontes(optarg, horizontes); break;
+            case 'i': intervalo_s = strtof(optarg, NULL); break;
+            case 'u': urgencia = atoi(optarg); break;
+            case 'w': hampel.janela = atoi(optarg); break;
+            case 'k': hampel.k = strtof(optarg, NULL); break;
+            case 'l': linha_tempo = 1; break;
+            case 'C': calibrar = 0; break;
+            case 'e': equivalencia = 1; break;
+            case 't': tolerancia = strtof(optarg, NULL); break;
+            default: uso(argv[0]); return 2;
+        }
+        if (erro) {
+            fprintf(stderr, "Faixa inválida para -%c: %s\n", opcao, optarg);
+            return 2;
+        }
+    }
+    if (optind != argc - 1 || intervalo_s <= 0) {
+        uso(argv[0]);
+        return 2;
+    }
+    const char *caminho = argv[optind];
+    if (binario < 0) {
+        const char *extensao = strrchr(caminho, '.');
+        binario = extensao && strcmp(extensao, ".bin") == 0;
+    }
+    if (janela.fim > TAMANHO_HISTORICO_MAX) {
+        fprintf(stderr, "Janela limitada a %d (TAMANHO_HISTORICO_MAX)\n", TAMANHO_HISTORICO_MAX);
+        janela.fim = TAMANHO_HISTORICO_MAX;
+    }
+
+    Traco_t traco = {0};
+    if (carregar_traco(caminho, binario, intervalo_s, &traco) != 0) {
+        fprintf(stderr, "Traço vazio ou ilegível: %s\n", caminho);
+        return 1;
+    }
+    // O Holt conta passos pelo período nominal; com tempos no traço usa o período médio
+    float periodo = (traco.tempo[traco.n - 1] - traco.tempo[0]) / (traco.n - 1);
+    printf("Traço: %zu leituras, %.1f s virtuais, período médio %.2f s, urgência %d C\n",
+           traco.n, traco.tempo[traco.n - 1] - traco.tempo[0], periodo, urgencia);
+
+    int combinacoes = passos_faixa(&alpha) * passos_faixa(&beta) * passos_faixa(&janela) * passos_faixa(&horizonte);
+    int detalhado = combinacoes == 1 || linha_tempo, falhas = 0;
+    printf("%6s %6s %5s %6s | %8s %8s | %8s %8s | %5s %11s\n", "alpha", "beta", "n", "horiz",
+           "EAM lin", "REQM lin", "EAM holt", "REQM holt", "trans", "amostras/s");
+    for (int ia = 0; ia < passos_faixa(&alpha); ia++)
+    for (int ib = 0; ib < passos_faixa(&beta); ib++)
+    for (int in = 0; in < passos_faixa(&janela); in++)
+    for (int ih = 0; ih < passos_faixa(&horizonte); ih++) {
+        ParametrosPrevisao_t parametros;
+        previsao_parametros_padrao(&parametros, periodo);
+        memcpy(parametros.horizontes_s, horizontes, sizeof(horizontes));
+        parametros.alpha_holt = alpha.inicio + ia * alpha.passo;
+        parametros.beta_holt = beta.inicio + ib * beta.passo;
+        parametros.tamanho_historico = (int)lroundf(janela.inicio + in * janela.passo);
+        parametros.horizontes_s[HORIZONTE_PADRAO] = horizonte.inicio + ih * horizonte.passo;
+
+        Resultado_t resultado;
+        simular(&traco, &parametros, hampel.janela ? &hampel : NULL, urgencia, calibrar, &resultado);
+        printf("%6.3f %6.3f %5d %6.0f | %8.3f %8.3f | %8.3f %8.3f | %5d %11.0f\n",
+               parametros.alpha_holt, parametros.beta_holt, parametros.tamanho_historico, parametros.horizontes_s[HORIZONTE_PADRAO],
+               resultado.eam_linear[HORIZONTE_PADRAO], resultado.reqm_linear[HORIZONTE_PADRAO],
+               resultado.eam_holt[HORIZONTE_PADRAO], resultado.reqm_holt[HORIZONTE_PADRAO],
+               resultado.transicoes, resultado.amostras_por_s);
+        if (detalhado) imprimir_detalhes(&traco, &parametros, &resultado);
+        free(resultado.niveis);
+        if (equivalencia) {
+            falhas |= comparar_ponto_fixo(&traco, &parametros, hampel.janela ? &hampel : NULL, tolerancia);
+            falhas |= comparar_multicanal(&traco, &parametros);
+        }
+    }
+    free(traco.tempo);
+    free(traco.temperatura);
+    return falhas;
+}
@@ -0,0 +1,147 @@
+#include <string.h>
+#include "agendador.h"
+
+void agendador_iniciar(Agendador_t *agendador, uint8_t janela_maxima, uint16_t bytes_prefixo) {
+    memset(agendador, 0, sizeof(*agendador));
+    agendador->janela_maxima = janela_maxima ? janela_maxima : 1;
+    agendador->janela = agendador->janela_maxima;
+    agendador->bytes_prefixo = bytes_prefixo;
+}
+
+int agendador_registrar(Agendador_t *agendador, const char *sufixo, uint16_t capacidade, uint8_t qos, bool retain) {
+    if (agendador->num_topicos >= AGENDADOR_TOPICOS_MAX ||
+        agendador->arena_usada + capacidade > AGENDADOR_ARENA_BYTES) return -1;
+    TopicoAgendado_t *topico = &agendador->topicos[agendador->num_topicos];
+    *topico = (TopicoAgendado_t){
+        .sufixo = sufixo,
+        .deslocamento = agendador->arena_usada,
+        .capacidade = capacidade,
+        .qos = qos,
+        .retain = retain,
+    };
+    agendador->arena_usada += capacidade;
+    return agendador->num_topicos++;
+}
+
+bool agendador_enfileirar(Agendador_t *agendador, int id, const void *dados, size_t tamanho,
+                          PrioridadePublicacao_t prioridade, uint32_t validade_ms, uint32_t agora_ms) {
+    if (id < 0 || id >= agendador->num_topicos) return false;
+    TopicoAgendado_t *topico = &agendador->topicos[id];
+    if (tamanho > topico->capacidade) {
+        agendador->contadores.descartadas++;
+        return false;
+    }
+    if (topico->pendente) {
+        // O valor anterior não chegou a sair: vale o novo, com a prioridade mais urgente dos dois
+        agendador->contadores.coalescidas++;
+        if (topico->prioridade < prioridade) prioridade = topico->prioridade;
+    } else {
+        topico->ordem = agendador->proxima_ordem++;
+    }
+    memcpy(&agendador->arena[topico->deslocamento], dados, tamanho);
+    topico->tamanho = (uint16_t)tamanho;
+    topico->prioridade = prioridade;
+    topico->expira_ms = validade_ms ? (agora_ms + validade_ms) | 1 : 0; // | 1: nunca 0 por acaso
+    topico->pendente = true;
+    agendador->contadores.enfileiradas++;
+    return true;
+}
+
+// Bytes do comprimento restante (codificação de 7 bits por byte do MQTT)
+static size_t bytes_comprimento(size_t restante) {
+    size_t bytes = 1;
+    while (restante >= 128) {
+        restante >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+size_t agendador_tamanho_mensagem(const Agendador_t *agendador, int id) {
+    const TopicoAgendado_t *topico = &agendador->topicos[id];
+    // Nome do tópico com 2 bytes de tamanho, id do pacote no QoS > 0, payload
+    size_t restante = 2 + agendador->bytes_prefixo + strlen(topico->sufixo) + (topico->qos ? 2 : 0) + topico->tamanho;
+    return 1 + bytes_comprimento(restante) + restante;
+}
+
+int agendador_proximo(Agendador_t *agendador, uint32_t agora_ms, size_t espaco_saida) {
+    int escolhido = -1;
+    for (int id = 0; id < agendador->num_topicos; id++) {
+        TopicoAgendado_t *topico = &agendador->topicos[id];
+        if (!topico->pendente) continue;
+        if (topico->expira_ms && (int32_t)(agora_ms - topico->expira_ms) >= 0) {
+            topico->pendente = false; // Envelheceu na fila: o próximo ciclo traz um valor novo
+            agendador->contadores.descartadas++;
+            continue;
+        }
+        const TopicoAgendado_t *atual = escolhido >= 0 ? &agendador->topicos[escolhido] : NULL;
+        if (!atual || topico->prioridade < atual->prioridade ||
+            (topico->prioridade == atual->prioridade && (int32_t)(topico->ordem - atual->ordem) < 0)) {
+            escolhido = id;
+        }
+    }
+    // Sem pular a fila: se o mais urgente não cabe, os demais esperam com ele
+    if (escolhido < 0 || agendador->em_voo >= agendador->janela ||
+        agendador_tamanho_mensagem(agendador, escolhido) > espaco_saida) return -1;
+    return escolhido;
+}
+
+const uint8_t *agendador_dados(const Agendador_t *agendador, int id) {
+    return &agendador->arena[agendador->topicos[id].deslocamento];
+}
+
+void agendador_enviado(Agendador_t *agendador, int id, uint32_t agora_ms) {
+    TopicoAgendado_t *topico = &agendador->topicos[id];
+    topico->pendente = false;
+    topico->em_voo++;
+    topico->enviado_ms = agora_ms;
+    agendador->em_voo++;
+    agendador->contadores.enviadas++;
+}
+
+static void reduzir_janela(Agendador_t *agendador) {
+    agendador->janela = agendador->janela > 1 ? agendador->janela / 2 : 1;
+    agendador->confirmadas_janela = 0;
+}
+
+void agendador_recusado(Agendador_t *agendador) {
+    agendador->contadores.recusadas++;
+    reduzir_janela(agendador);
+}
+
+void agendador_confirmado(Agendador_t *agendador, int id, bool sucesso, uint32_t agora_ms) {
+    if (id < 0 || id >= agendador->num_topicos) return;
+    TopicoAgendado_t *topico = &agendador->topicos[id];
+    if (!topico->em_voo) return; // Envio de antes da última desconexão
+    topico->em_voo--;
+    agendador->em_voo--;
+    if (!sucesso) {
+        agendador->contadores.falhas++;
+        topico->pendente = true; // Reenvia o último valor (se ainda não expirou)
+        reduzir_janela(agendador);
+        return;
+    }
+    agendador->contadores.confirmadas++;
+    int32_t amostra = (int32_t)(agora_ms - topico->enviado_ms);
+    agendador->confirmacao_ms += (amostra - (int32_t)agendador->confirmacao_ms) / 8;
+    if (++agendador->confirmadas_janela >= agendador->janela) {
+        agendador->confirmadas_janela = 0;
+        if (agendador->janela < agendador->janela_maxima) agendador->janela++;
+    }
+}
+
+void agendador_desconectado(Agendador_t *agendador) {
+    for (int id = 0; id < agendador->num_topicos; id++) {
+        TopicoAgendado_t *topico = &agendador->topicos[id];
+        if (topico->em_voo) topico->pendente = true;
+        topico->em_voo = 0;
+    }
+    agendador->em_voo = 0;
+    agendador->confirmadas_janela = 0;
+}
+
+int agendador_pendentes(const Agendador_t *agendador) {
+    int pendentes = 0;
+    for (int id = 0; id < agendador->num_topicos; id++) pendentes += agendador->topicos[id].pendente;
+    return pendentes;
+}
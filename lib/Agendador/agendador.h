@@ -0,0 +1,90 @@
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- Dimensionamento ---------- */
+#define AGENDADOR_TOPICOS_MAX   12    // Tópicos registrados
+#define AGENDADOR_ARENA_BYTES   1536  // Soma das capacidades de payload dos tópicos
+
+/* ---------- Tipos ---------- */
+// Menor valor sai primeiro; dentro da mesma prioridade, o enfileirado há mais tempo
+typedef enum {
+    PRIORIDADE_ALARME,          // Mudança de situação da temperatura
+    PRIORIDADE_ESTADO,          // Presença, situação e ajustes
+    PRIORIDADE_TELEMETRIA,      // Leituras e previsões periódicas (podem expirar)
+    NUM_PRIORIDADES
+} PrioridadePublicacao_t;
+
+typedef struct {
+    uint32_t enfileiradas;      // Valores aceitos
+    uint32_t coalescidas;       // Valores substituídos por um mais novo do mesmo tópico antes do envio
+    uint32_t descartadas;       // Valores expirados ou maiores que a capacidade do tópico
+    uint32_t enviadas;          // Publicações aceitas pelo cliente MQTT
+    uint32_t confirmadas;       // Confirmações recebidas (PUBACK, ou envio no QoS 0)
+    uint32_t falhas;            // Confirmações com erro (timeout): o valor volta para a fila
+    uint32_t recusadas;         // Publicações recusadas pelo cliente (sem requisição ou anel de saída cheio)
+} ContadoresAgendador_t;
+
+// Um valor pendente por tópico: o payload mais recente fica na fatia do tópico na arena
+typedef struct {
+    const char *sufixo;         // Tópico relativo ao tópico base
+    uint16_t deslocamento;      // Início da fatia na arena
+    uint16_t capacidade;
+    uint16_t tamanho;           // Payload atual
+    uint8_t  qos;
+    bool     retain;
+    bool     pendente;          // Valor atual ainda não enviado
+    uint8_t  em_voo;            // Envios deste tópico aguardando confirmação
+    PrioridadePublicacao_t prioridade;
+    uint32_t ordem;             // Ordem de enfileiramento (o mais antigo sai primeiro)
+    uint32_t expira_ms;         // 0 = não expira
+    uint32_t enviado_ms;        // Último envio (tempo até a confirmação)
+} TopicoAgendado_t;
+
+/* Janela de publicações sem confirmação ajustada como no TCP: cresce uma unidade a cada janela
+ * inteira confirmada, até o máximo, e cai pela metade a cada recusa ou timeout. Com o broker
+ * lento, a telemetria espera coalescida (um valor por tópico) atrás dos alarmes em vez de
+ * esgotar as requisições do cliente. Sem travas: o chamador serializa o acesso */
+typedef struct {
+    TopicoAgendado_t topicos[AGENDADOR_TOPICOS_MAX];
+    int      num_topicos;
+    uint8_t  arena[AGENDADOR_ARENA_BYTES];
+    uint16_t arena_usada;
+    uint16_t bytes_prefixo;     // Tópico base somado a cada sufixo no tamanho da mensagem
+    uint32_t proxima_ordem;
+    uint8_t  janela, janela_maxima;
+    uint8_t  em_voo;
+    uint8_t  confirmadas_janela; // Confirmações desde o último ajuste da janela
+    uint32_t confirmacao_ms;    // Tempo médio até a confirmação (média móvel de 1/8)
+    ContadoresAgendador_t contadores;
+} Agendador_t;
+
+/* ---------- Funções ---------- */
+//Esvazia o agendador; bytes_prefixo é o tamanho do tópico base
+void agendador_iniciar(Agendador_t *agendador, uint8_t janela_maxima, uint16_t bytes_prefixo);
+//Registra um tópico com 'capacidade' bytes de payload; retorna o id (em ordem de registro) ou -1
+int agendador_registrar(Agendador_t *agendador, const char *sufixo, uint16_t capacidade, uint8_t qos, bool retain);
+//Guarda o valor mais recente do tópico, substituindo o pendente (validade_ms = 0: não expira)
+bool agendador_enfileirar(Agendador_t *agendador, int id, const void *dados, size_t tamanho,
+                          PrioridadePublicacao_t prioridade, uint32_t validade_ms, uint32_t agora_ms);
+//Próximo tópico a enviar, se a janela permitir e a mensagem couber em 'espaco_saida' bytes; -1 se nenhum
+int agendador_proximo(Agendador_t *agendador, uint32_t agora_ms, size_t espaco_saida);
+//Payload atual do tópico
+const uint8_t *agendador_dados(const Agendador_t *agendador, int id);
+//O cliente aceitou a publicação do tópico
+void agendador_enviado(Agendador_t *agendador, int id, uint32_t agora_ms);
+//O cliente recusou a publicação: o valor continua pendente e a janela diminui
+void agendador_recusado(Agendador_t *agendador);
+//Confirmação de uma publicação do tópico; sem sucesso, o valor volta a ficar pendente
+void agendador_confirmado(Agendador_t *agendador, int id, bool sucesso, uint32_t agora_ms);
+//Conexão perdida: as publicações sem confirmação se perdem com ela e são reenviadas na próxima
+void agendador_desconectado(Agendador_t *agendador);
+//Tópicos com valor pendente
+int agendador_pendentes(const Agendador_t *agendador);
+//Tamanho da mensagem PUBLISH do valor atual do tópico
+size_t agendador_tamanho_mensagem(const Agendador_t *agendador, int id);
+
+#endif /* AGENDADOR_H */
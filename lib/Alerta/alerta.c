@@ -0,0 +1,59 @@
+#include "alerta.h"
+
+// Limiares relativos à temperatura de urgência (°C)
+const RegraAlerta_t REGRAS_ALERTA[NUM_NIVEIS_ALERTA] = {
+    [NIVEL_NORMAL]  = { GRANDEZA_PREVISTA,         0.0f, 0.0f,     0, HORIZONTE_PADRAO, false }, // Não usada: nível de repouso
+    [NIVEL_ATENCAO] = { GRANDEZA_PREVISTA,        -5.0f, 0.5f, 10000, HORIZONTE_PADRAO, true  }, // Previsão a até 5 °C da urgência
+    [NIVEL_ALERTA]  = { GRANDEZA_LIMITE_SUPERIOR,  0.0f, 0.5f, 15000, HORIZONTE_PADRAO, false }, // Limite superior acima da urgência
+    [NIVEL_GRAVE]   = { GRANDEZA_ATUAL,            0.0f, 0.5f, 30000, HORIZONTE_PADRAO, false }, // Temperatura atual acima da urgência
+};
+
+const char *const NOMES_ALERTA[NUM_NIVEIS_ALERTA] = {
+    "Normal", "Atenção", "Alerta", "Grave"
+};
+
+const char *const ROTULOS_ALERTA_DISPLAY[NUM_NIVEIS_ALERTA] = {
+    "Normal", "Atencao", "Alerta", "Grave"
+};
+
+static float valor_da_regra(const RegraAlerta_t *regra, float temp_atual, const ResultadosPrevisao_t *previsoes) {
+    switch (regra->grandeza) {
+        case GRANDEZA_ATUAL:           return temp_atual;
+        case GRANDEZA_LIMITE_SUPERIOR: return previsoes->previsao_linear[regra->horizonte] + previsoes->margem_linear[regra->horizonte];
+        default:                       return previsoes->previsao_linear[regra->horizonte];
+    }
+}
+
+//Maior nível cuja regra é satisfeita; níveis até o vigente usam o limiar relaxado pela histerese
+static NivelAlerta_t avaliar(float temp_atual, const ResultadosPrevisao_t *previsoes, int urgencia, NivelAlerta_t vigente) {
+    for (int nivel = NUM_NIVEIS_ALERTA - 1; nivel > NIVEL_NORMAL; nivel--) {
+        const RegraAlerta_t *regra = &REGRAS_ALERTA[nivel];
+        float valor = valor_da_regra(regra, temp_atual, previsoes);
+        float limiar = regra->limiar - (nivel <= (int)vigente ? regra->histerese : 0.0f);
+        float excesso = valor - urgencia;
+        if (excesso > limiar || (regra->inclusivo && excesso == limiar)) return (NivelAlerta_t)nivel;
+    }
+    return NIVEL_NORMAL;
+}
+
+void alerta_iniciar(MaquinaAlerta_t *maquina, uint32_t agora_ms) {
+    maquina->nivel = NIVEL_NORMAL;
+    maquina->desde_ms = agora_ms;
+}
+
+NivelAlerta_t alerta_classificar(float temp_atual, const ResultadosPrevisao_t *previsoes, int urgencia) {
+    return avaliar(temp_atual, previsoes, urgencia, NIVEL_NORMAL);
+}
+
+NivelAlerta_t alerta_atualizar(MaquinaAlerta_t *maquina, float temp_atual, const ResultadosPrevisao_t *previsoes,
+                               int urgencia, uint32_t agora_ms) {
+    NivelAlerta_t candidato = avaliar(temp_atual, previsoes, urgencia, maquina->nivel);
+    bool pode_mudar = candidato > maquina->nivel ||
+                      (candidato < maquina->nivel &&
+                       agora_ms - maquina->desde_ms >= REGRAS_ALERTA[maquina->nivel].permanencia_ms);
+    if (pode_mudar) {
+        maquina->nivel = candidato;
+        maquina->desde_ms = agora_ms;
+    }
+    return maquina->nivel;
+}
@@ -0,0 +1,52 @@
+#ifndef ALERTA_H
+#define ALERTA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "previsao.h"
+
+/* ---------- Níveis de alerta (ordem crescente de gravidade) ---------- */
+typedef enum {
+    NIVEL_NORMAL,
+    NIVEL_ATENCAO,
+    NIVEL_ALERTA,
+    NIVEL_GRAVE,
+    NUM_NIVEIS_ALERTA
+} NivelAlerta_t;
+
+/* ---------- Regra de cada nível ---------- */
+typedef enum {
+    GRANDEZA_PREVISTA,          // Compara a temperatura prevista com a urgência
+    GRANDEZA_LIMITE_SUPERIOR,   // Compara o limite superior do intervalo da previsão com a urgência
+    GRANDEZA_ATUAL              // Compara a temperatura atual com a urgência
+} GrandezaAlerta_t;
+
+typedef struct {
+    GrandezaAlerta_t grandeza;  // Valor comparado com a urgência
+    float limiar;               // Entra no nível quando (valor - urgência) > limiar
+    float histerese;            // Permanece enquanto (valor - urgência) > limiar - histerese
+    uint32_t permanencia_ms;    // Tempo mínimo no nível antes de poder baixar
+    int horizonte;              // Índice em HORIZONTES_PREVISAO_S das grandezas previstas
+    bool inclusivo;             // Entra também com (valor - urgência) igual ao limiar (>= em vez de >)
+} RegraAlerta_t;
+
+extern const RegraAlerta_t REGRAS_ALERTA[NUM_NIVEIS_ALERTA];
+extern const char *const NOMES_ALERTA[NUM_NIVEIS_ALERTA];         // Nomes publicados via MQTT
+extern const char *const ROTULOS_ALERTA_DISPLAY[NUM_NIVEIS_ALERTA]; // Rótulos que a fonte do OLED desenha
+
+/* ---------- Máquina de estados ---------- */
+typedef struct {
+    NivelAlerta_t nivel;  // Nível vigente
+    uint32_t desde_ms;    // Instante da última transição
+} MaquinaAlerta_t;
+
+//Inicia a máquina no nível normal
+void alerta_iniciar(MaquinaAlerta_t *maquina, uint32_t agora_ms);
+//Classifica sem histerese nem permanência (equivalente à antiga determinar_situacao)
+NivelAlerta_t alerta_classificar(float temp_atual, const ResultadosPrevisao_t *previsoes, int urgencia);
+//Avança a máquina: sobe de nível imediatamente, desce só após a histerese e a permanência mínima
+//Usa a regressão linear (previsão e intervalo) em cada horizonte; cada regra escolhe o seu
+NivelAlerta_t alerta_atualizar(MaquinaAlerta_t *maquina, float temp_atual, const ResultadosPrevisao_t *previsoes,
+                               int urgencia, uint32_t agora_ms);
+
+#endif /* ALERTA_H */
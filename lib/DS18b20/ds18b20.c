@@ -56,18 +56,31 @@ bool ds18b20_reset(void) {
     return present;
 }
 
-//Lê a temperatura do sensor
-float ds18b20_get_temperature(void) {
+//Inicia a conversão de temperatura
+void ds18b20_start_conversion(void) {
     ds18b20_reset();
     write_byte(0xCC); //Ignora ROM (Skip ROM)
     write_byte(0x44); //Inicia conversão de temperatura
-    sleep_ms(750); //Aguarda conversão
+}
 
+//Lê o resultado da última conversão
+int16_t ds18b20_read_raw(void) {
     ds18b20_reset();
     write_byte(0xCC);
     write_byte(0xBE); //Lê o scratchpad
     uint8_t lsb = read_byte();
     uint8_t msb = read_byte();
-    int16_t raw = (msb << 8) | lsb; //Combina bytes para valor bruto
-    return raw * 0.0625f; //Converte para graus Celsius
+    return (int16_t)((msb << 8) | lsb); //Combina bytes para valor bruto (1/16 °C)
+}
+
+//Lê a temperatura bruta do sensor
+int16_t ds18b20_get_raw(void) {
+    ds18b20_start_conversion();
+    sleep_ms(DS18B20_TEMPO_CONVERSAO_MS); //Aguarda conversão
+    return ds18b20_read_raw();
+}
+
+//Lê a temperatura do sensor
+float ds18b20_get_temperature(void) {
+    return ds18b20_get_raw() * 0.0625f; //Converte para graus Celsius
 }
\ No newline at end of file
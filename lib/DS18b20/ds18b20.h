@@ -5,10 +5,18 @@
 #include <stdint.h>
 #include "pico/stdlib.h"
 
+#define DS18B20_TEMPO_CONVERSAO_MS 750 //Conversão de 12 bits
+
 //Inicializa o sensor DS18B20 no pino especificado
 void ds18b20_init(uint pin); //Configura o barramento 1-Wire
 //Verifica a presença do sensor
 bool ds18b20_reset(void); //Retorna true se o sensor responder
+//Inicia uma conversão; o resultado fica pronto após DS18B20_TEMPO_CONVERSAO_MS
+void ds18b20_start_conversion(void);
+//Lê o resultado da última conversão
+int16_t ds18b20_read_raw(void); //Retorna o valor do scratchpad em 1/16 °C
+//Lê a temperatura bruta do sensor
+int16_t ds18b20_get_raw(void); //Converte, espera a conversão e retorna o valor em 1/16 °C
 //Lê a temperatura do sensor
 float ds18b20_get_temperature(void); //Retorna temperatura em °C (resolução de 12 bits)
 
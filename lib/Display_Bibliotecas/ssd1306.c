@@ -1,30 +1,36 @@
 #include "ssd1306.h"
 #include "font.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "hardware/i2c.h"
 
-// Inicializa a estrutura do display SSD1306
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+// Inicializa a estrutura do display SSD1306 sobre o buffer dado
+void ssd1306_init_static(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c, uint8_t *buffer) {
+    (void)external_vcc;
     ssd->width = width;
     ssd->height = height;
     ssd->pages = height / 8;
     ssd->address = address;
     ssd->i2c_port = i2c;
-    ssd->bufsize = ssd->pages * ssd->width + 1;
-    
-    // Aloca buffer de dados
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
-    if (ssd->ram_buffer == NULL) {
-        // Em caso de falha, poderia adicionar tratamento de erro (ex.: log ou loop infinito)
-        while (1);
-    }
-    
+    ssd->bufsize = SSD1306_BUFSIZE(width, height);
+    ssd->ram_buffer = buffer;
+    memset(ssd->ram_buffer, 0, ssd->bufsize);
+
     // Inicializa buffers
     ssd->ram_buffer[0] = 0x40; // Prefixo de dados
     ssd->port_buffer[0] = 0x00; // Prefixo de comando (Co=0, D/C=0)
 }
 
+// Inicializa a estrutura do display SSD1306 com o buffer alocado no heap
+bool ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+    uint8_t *buffer = calloc(SSD1306_BUFSIZE(width, height), sizeof(uint8_t));
+    ssd->ram_buffer = NULL;
+    if (buffer == NULL) return false; // Sem memória: o chamador decide (o display fica desativado)
+    ssd1306_init_static(ssd, width, height, external_vcc, address, i2c, buffer);
+    return true;
+}
+
 // Configura os parâmetros iniciais do display
 void ssd1306_config(ssd1306_t *ssd) {
     ssd1306_command(ssd, 0xAE); // Desliga o display
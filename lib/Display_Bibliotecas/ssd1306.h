@@ -14,8 +14,15 @@ typedef struct {
     uint8_t port_buffer[2];
 } ssd1306_t;
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height,
+// Tamanho do buffer de quadro: 1 byte de prefixo I2C + uma linha de bytes por página
+#define SSD1306_BUFSIZE(width, height) ((height) / 8 * (width) + 1)
+
+// Aloca o buffer no heap; retorna false se não houver memória
+bool ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height,
                   bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+// Usa um buffer do chamador com SSD1306_BUFSIZE(width, height) bytes (alocação estática)
+void ssd1306_init_static(ssd1306_t *ssd, uint8_t width, uint8_t height,
+                         bool external_vcc, uint8_t address, i2c_inst_t *i2c, uint8_t *buffer);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
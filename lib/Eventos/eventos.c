@@ -0,0 +1,52 @@
+#include "eventos.h"
+#include "task.h"
+
+typedef struct {
+    uint32_t mascara;           // Tipos assinados
+    QueueHandle_t fila;         // Fila do assinante (ou NULL)
+    CallbackEvento_t callback;  // Callback do assinante (ou NULL)
+    void *contexto;             // Argumento do callback
+    volatile uint32_t descartes; // Eventos perdidos por fila cheia
+} Assinante_t;
+
+static Assinante_t assinantes[EVENTOS_MAX_ASSINANTES];
+static int num_assinantes = 0;
+
+//As assinaturas são feitas na inicialização, antes do escalonador, então dispensam trava
+static int registrar(uint32_t mascara, QueueHandle_t fila, CallbackEvento_t callback, void *contexto) {
+    if (num_assinantes >= EVENTOS_MAX_ASSINANTES) return -1;
+    assinantes[num_assinantes] = (Assinante_t){ .mascara = mascara, .fila = fila, .callback = callback, .contexto = contexto };
+    return num_assinantes++;
+}
+
+int eventos_assinar_fila(uint32_t mascara, QueueHandle_t fila) {
+    return registrar(mascara, fila, NULL, NULL);
+}
+
+int eventos_assinar_callback(uint32_t mascara, CallbackEvento_t callback, void *contexto) {
+    return registrar(mascara, NULL, callback, contexto);
+}
+
+int eventos_publicar(const Evento_t *evento) {
+    uint32_t bit = EVENTO_MASCARA(evento->tipo);
+    int entregues = 0;
+    for (int i = 0; i < num_assinantes; i++) {
+        Assinante_t *assinante = &assinantes[i];
+        if (!(assinante->mascara & bit)) continue;
+        if (assinante->callback) {
+            assinante->callback(evento, assinante->contexto);
+            entregues++;
+        } else if (xQueueSend(assinante->fila, evento, 0) == pdTRUE) {
+            entregues++;
+        } else {
+            taskENTER_CRITICAL(); // Vários produtores podem descartar ao mesmo tempo
+            assinante->descartes++;
+            taskEXIT_CRITICAL();
+        }
+    }
+    return entregues;
+}
+
+uint32_t eventos_descartes(int id) {
+    return (id >= 0 && id < num_assinantes) ? assinantes[id].descartes : 0;
+}
@@ -0,0 +1,75 @@
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "alerta.h"
+#include "previsao.h"
+#include "hampel.h"
+
+#define EVENTOS_MAX_ASSINANTES 8  // Assinantes registrados no barramento
+
+/* ---------- Tipos de evento ---------- */
+typedef enum {
+    EVENTO_AMOSTRA,   // Nova leitura filtrada do sensor
+    EVENTO_PREVISAO,  // Novas previsões (linear e Holt)
+    EVENTO_COMANDO,   // Comando do usuário (botões/joystick)
+    EVENTO_ALARME,    // Mudança na situação da temperatura
+    EVENTO_NUM_TIPOS
+} TipoEvento_t;
+
+#define EVENTO_MASCARA(tipo) (1u << (tipo))  // Bit de assinatura de um tipo de evento
+
+/* ---------- Cargas dos eventos ---------- */
+typedef struct {
+    float temperatura;      // Temperatura registrada
+    TickType_t marca_tempo; // Marca de tempo da leitura
+    uint64_t marca_us;      // Início da conversão (time_us_64)
+    ContadoresHampel_t rejeicoes; // Totais do filtro de discrepantes até esta leitura
+} DadosTemperatura_t;
+
+typedef enum {
+    COMANDO_PROXIMA_TELA,       // Avança para a próxima tela
+    COMANDO_TELA_ANTERIOR,      // Retorna à tela anterior
+    COMANDO_AJUSTAR_URGENCIA_SUBIR,  // Aumenta temperatura de urgência
+    COMANDO_AJUSTAR_URGENCIA_DESCER, // Diminui temperatura de urgência
+    COMANDO_FONTE_TENDENCIA     // Troca a fonte do gráfico de tendência (valor = +1/-1)
+} TipoComando_t;
+
+typedef struct {
+    TipoComando_t tipo;     // Tipo do comando
+    int valor;              // Valor associado ao comando
+} ComandoUsuario_t;
+
+typedef struct {
+    NivelAlerta_t nivel;    // Novo nível de alerta
+    float temperatura;      // Temperatura no momento da mudança
+    int   urgencia;         // Limite de urgência vigente
+} DadosAlarme_t;
+
+typedef struct {
+    TipoEvento_t tipo;
+    union {
+        DadosTemperatura_t   amostra;
+        ResultadosPrevisao_t previsao;
+        ComandoUsuario_t     comando;
+        DadosAlarme_t        alarme;
+    };
+} Evento_t;
+
+// Assinante por callback: recebe um ponteiro para o evento do produtor, sem cópia
+typedef void (*CallbackEvento_t)(const Evento_t *evento, void *contexto);
+
+/* ---------- API ---------- */
+//Registra uma fila própria do assinante (uma cópia por evento); retorna o id ou -1
+int eventos_assinar_fila(uint32_t mascara, QueueHandle_t fila);
+//Registra um callback chamado no contexto do produtor; retorna o id ou -1
+int eventos_assinar_callback(uint32_t mascara, CallbackEvento_t callback, void *contexto);
+//Entrega o evento a todos os assinantes do tipo sem bloquear; retorna quantos o receberam
+int eventos_publicar(const Evento_t *evento);
+//Eventos descartados para um assinante por fila cheia
+uint32_t eventos_descartes(int id);
+
+#endif /* EVENTOS_H */
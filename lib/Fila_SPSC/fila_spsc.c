@@ -0,0 +1,34 @@
+#include "fila_spsc.h"
+#include <string.h>
+
+void fila_spsc_iniciar(FilaSPSC_t *fila, void *armazenamento, uint16_t tamanho_item, uint16_t capacidade) {
+    fila->dados = armazenamento;
+    fila->tamanho_item = tamanho_item;
+    fila->capacidade = capacidade;
+    fila->escrita = 0;
+    fila->leitura = 0;
+    fila->descartes = 0;
+}
+
+bool fila_spsc_enviar(FilaSPSC_t *fila, const void *item) {
+    uint32_t escrita = fila->escrita;
+    uint32_t leitura = __atomic_load_n(&fila->leitura, __ATOMIC_ACQUIRE);
+    if (escrita - leitura >= fila->capacidade) {
+        fila->descartes++;
+        return false; // Fila cheia
+    }
+    uint32_t pos = escrita & (fila->capacidade - 1);
+    memcpy(&fila->dados[pos * fila->tamanho_item], item, fila->tamanho_item);
+    __atomic_store_n(&fila->escrita, escrita + 1, __ATOMIC_RELEASE); // Publica o item só após a cópia
+    return true;
+}
+
+bool fila_spsc_receber(FilaSPSC_t *fila, void *item) {
+    uint32_t leitura = fila->leitura;
+    uint32_t escrita = __atomic_load_n(&fila->escrita, __ATOMIC_ACQUIRE);
+    if (leitura == escrita) return false; // Fila vazia
+    uint32_t pos = leitura & (fila->capacidade - 1);
+    memcpy(item, &fila->dados[pos * fila->tamanho_item], fila->tamanho_item);
+    __atomic_store_n(&fila->leitura, leitura + 1, __ATOMIC_RELEASE); // Libera a posição para o produtor
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef FILA_SPSC_H
+#define FILA_SPSC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Fila sem travas para um único produtor e um único consumidor.
+ * Pode ser usada entre núcleos: cada índice só é escrito por um dos lados. */
+typedef struct {
+    uint8_t *dados;                 // Armazenamento dos itens (capacidade * tamanho_item)
+    uint16_t tamanho_item;          // Tamanho de cada item em bytes
+    uint16_t capacidade;            // Número de itens (potência de 2)
+    volatile uint32_t escrita;      // Contador de itens escritos (só o produtor altera)
+    volatile uint32_t leitura;      // Contador de itens lidos (só o consumidor altera)
+    volatile uint32_t descartes;    // Itens recusados por fila cheia
+} FilaSPSC_t;
+
+//Prepara a fila sobre um armazenamento fornecido pelo chamador
+void fila_spsc_iniciar(FilaSPSC_t *fila, void *armazenamento, uint16_t tamanho_item, uint16_t capacidade);
+//Insere um item (lado produtor); retorna false se a fila estiver cheia
+bool fila_spsc_enviar(FilaSPSC_t *fila, const void *item);
+//Remove um item (lado consumidor); retorna false se a fila estiver vazia
+bool fila_spsc_receber(FilaSPSC_t *fila, void *item);
+
+#endif /* FILA_SPSC_H */
@@ -40,9 +40,21 @@
   * See http://www.freertos.org/a00110.html
   *----------------------------------------------------------*/
  
+ /* PERFIL_BAIXO_CONSUMO=1 (opção PERFIL_BAIXO_CONSUMO do CMake) suprime o tick
+    enquanto o sistema está ocioso e dorme até o próximo evento (ver main.c). */
+ #ifndef PERFIL_BAIXO_CONSUMO
+ #define PERFIL_BAIXO_CONSUMO                    0
+ #endif
+
  /* Scheduler Related */
  #define configUSE_PREEMPTION                    1
+ #if PERFIL_BAIXO_CONSUMO
+ /* 2 = implementação própria de vPortSuppressTicksAndSleep (alarme do timer de hardware) */
+ #define configUSE_TICKLESS_IDLE                 2
+ #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   5
+ #else
  #define configUSE_TICKLESS_IDLE                 0
+ #endif
  #define configUSE_IDLE_HOOK                     0
  #define configUSE_TICK_HOOK                     0
  #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -69,9 +81,21 @@
  #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
  
  /* Memory allocation related definitions. */
+ /* PERFIL_ESTATICO=1 (opção PERFIL_ESTATICO do CMake) coloca tarefas, pilhas, filas, mutexes
+    e timers em .bss; o heap do FreeRTOS deixa de existir. O kernel fornece a memória das
+    tarefas ociosa e de timers. */
+ #ifndef PERFIL_ESTATICO
+ #define PERFIL_ESTATICO                         0
+ #endif
+ #if PERFIL_ESTATICO
+ #define configSUPPORT_STATIC_ALLOCATION         1
+ #define configSUPPORT_DYNAMIC_ALLOCATION        0
+ #define configKERNEL_PROVIDED_STATIC_MEMORY     1
+ #else
  #define configSUPPORT_STATIC_ALLOCATION         0
  #define configSUPPORT_DYNAMIC_ALLOCATION        1
  #define configTOTAL_HEAP_SIZE                   (128*1024)
+ #endif
  #define configAPPLICATION_ALLOCATED_HEAP        0
  
  /* Hook function related definitions. */
@@ -80,7 +104,18 @@
  #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
  
  /* Run time and task stats gathering related definitions. */
+ #if PERFIL_BAIXO_CONSUMO
+ /* Contabiliza o tempo da tarefa ociosa em microssegundos para o relatório de ciclo de trabalho */
+ #define configGENERATE_RUN_TIME_STATS           1
+ #ifndef __ASSEMBLER__
+ #include <stdint.h>
+ extern uint32_t contador_tempo_execucao(void);
+ #endif
+ #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ #define portGET_RUN_TIME_COUNTER_VALUE()        contador_tempo_execucao()
+ #else
  #define configGENERATE_RUN_TIME_STATS           0
+ #endif
  #define configUSE_TRACE_FACILITY                1
  #define configUSE_STATS_FORMATTING_FUNCTIONS    0
  
@@ -102,9 +137,26 @@
  */
  
  /* SMP port only */
+ /* PERFIL_SMP=1 (opção PERFIL_SMP do CMake) usa os dois núcleos do RP2040:
+    núcleo 0 para Wi-Fi/MQTT/cyw43 e núcleo 1 para as tarefas de tempo real. */
+ #ifndef PERFIL_SMP
+ #define PERFIL_SMP                              0
+ #endif
+
+ #if PERFIL_SMP
+ #define configNUM_CORES                         2
+ #define configTICK_CORE                         0
+ #define configUSE_CORE_AFFINITY                 1
+ #define configUSE_PASSIVE_IDLE_HOOK             0
+ #else
  #define configNUM_CORES                         1
  #define configTICK_CORE                         1
+ #endif
  #define configRUN_MULTIPLE_PRIORITIES           1
+
+ #if PERFIL_SMP && PERFIL_BAIXO_CONSUMO
+ #error "PERFIL_BAIXO_CONSUMO requer um único núcleo (o tickless idle não é suportado no port SMP)"
+ #endif
  
  /* RP2040 specific */
  #define configSUPPORT_PICO_SYNC_INTEROP         1
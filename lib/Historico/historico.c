@@ -0,0 +1,117 @@
+#include <math.h>
+#include <string.h>
+#include "historico.h"
+
+_Static_assert(sizeof(Historico_t) <= HISTORICO_ORCAMENTO_BYTES,
+               "Historico_t passa de HISTORICO_ORCAMENTO_BYTES: reduza HISTORICO_MINUTOS/HORAS/DIAS");
+
+static const uint32_t PERIODOS_S[NUM_NIVEIS_HISTORICO] = { 60, 3600, 86400 };
+
+void historico_iniciar(Historico_t *historico, uint32_t tempo_s) {
+    static const uint16_t capacidades[NUM_NIVEIS_HISTORICO] = { HISTORICO_MINUTOS, HISTORICO_HORAS, HISTORICO_DIAS };
+    memset(historico, 0, sizeof(*historico));
+    uint16_t base = 0;
+    for (int nivel = 0; nivel < NUM_NIVEIS_HISTORICO; nivel++) {
+        Camada_t *camada = &historico->camadas[nivel];
+        camada->base = base;
+        base += capacidades[nivel];
+        camada->capacidade = capacidades[nivel];
+        camada->periodo_s = PERIODOS_S[nivel];
+        camada->inicio_s = tempo_s - tempo_s % camada->periodo_s;
+        camada->preenchidos = 1;
+    }
+}
+
+//Avança a camada até o intervalo que contém tempo_s; lacunas sem leituras ficam vazias
+static void avancar(Camada_t *camada, Agregado_t *agregados, uint32_t tempo_s) {
+    if (tempo_s < camada->inicio_s) return; // Leitura atrasada: fica no intervalo atual
+    uint32_t passos = (tempo_s - camada->inicio_s) / camada->periodo_s;
+    if (!passos) return;
+    camada->inicio_s += passos * camada->periodo_s;
+    if (passos > camada->capacidade) passos = camada->capacidade; // Lacuna maior que o anel: todos vazios
+    while (passos--) {
+        camada->atual = (camada->atual + 1) % camada->capacidade;
+        memset(&agregados[camada->atual], 0, sizeof(Agregado_t));
+        if (camada->preenchidos < camada->capacidade) camada->preenchidos++;
+    }
+}
+
+void historico_registrar(Historico_t *historico, float temperatura, uint32_t tempo_s) {
+    int16_t centesimos = (int16_t)lroundf(temperatura * 100.0f);
+    for (int nivel = 0; nivel < NUM_NIVEIS_HISTORICO; nivel++) {
+        Camada_t *camada = &historico->camadas[nivel];
+        Agregado_t *agregados = &historico->agregados[camada->base];
+        avancar(camada, agregados, tempo_s);
+        Agregado_t *agregado = &agregados[camada->atual];
+        if (!agregado->contagem || centesimos < agregado->minimo) agregado->minimo = centesimos;
+        if (!agregado->contagem || centesimos > agregado->maximo) agregado->maximo = centesimos;
+        agregado->soma += centesimos;
+        agregado->ultimo = centesimos;
+        agregado->contagem++;
+    }
+}
+
+int historico_quantidade(const Historico_t *historico, NivelHistorico_t nivel) {
+    return historico->camadas[nivel].preenchidos;
+}
+
+bool historico_ler(const Historico_t *historico, NivelHistorico_t nivel, int idade, Agregado_t *agregado, uint32_t *inicio_s) {
+    const Camada_t *camada = &historico->camadas[nivel];
+    if (idade < 0 || idade >= camada->preenchidos) return false;
+    int posicao = (camada->atual + camada->capacidade - idade) % camada->capacidade;
+    *agregado = historico->agregados[camada->base + posicao];
+    if (inicio_s) *inicio_s = camada->inicio_s - (uint32_t)idade * camada->periodo_s;
+    return true;
+}
+
+uint32_t historico_periodo_s(NivelHistorico_t nivel) {
+    return PERIODOS_S[nivel];
+}
+
+float historico_media(const Agregado_t *agregado) {
+    return agregado->contagem ? agregado->soma / (100.0f * agregado->contagem) : NAN;
+}
+
+int historico_contar(const Historico_t *historico, NivelHistorico_t nivel, uint32_t inicio_s, uint32_t fim_s, uint32_t *primeiro_s) {
+    const Camada_t *camada = &historico->camadas[nivel];
+    uint32_t mais_antigo = camada->inicio_s - (uint32_t)(camada->preenchidos - 1) * camada->periodo_s;
+    uint32_t limite = camada->inicio_s + camada->periodo_s; // Fim do intervalo atual
+    *primeiro_s = mais_antigo;
+    if (inicio_s >= limite) return 0;
+    if (inicio_s < mais_antigo) inicio_s = mais_antigo;
+    inicio_s += (camada->periodo_s - (inicio_s - mais_antigo) % camada->periodo_s) % camada->periodo_s; // Próximo início alinhado
+    if (fim_s > limite) fim_s = limite;
+    *primeiro_s = inicio_s;
+    return fim_s > inicio_s ? (int)((fim_s - inicio_s + camada->periodo_s - 1) / camada->periodo_s) : 0;
+}
+
+uint8_t *historico_escrever16(uint8_t *p, uint16_t valor) {
+    p[0] = (uint8_t)valor;
+    p[1] = (uint8_t)(valor >> 8);
+    return p + 2;
+}
+
+uint8_t *historico_escrever32(uint8_t *p, uint32_t valor) {
+    return historico_escrever16(historico_escrever16(p, (uint16_t)valor), (uint16_t)(valor >> 16));
+}
+
+int historico_codificar(const Historico_t *historico, NivelHistorico_t nivel, uint32_t inicio_s, int quantidade, uint8_t *saida) {
+    static const Agregado_t vazio;
+    const Camada_t *camada = &historico->camadas[nivel];
+    uint8_t *p = saida;
+    for (int i = 0; i < quantidade; i++) {
+        uint32_t t = inicio_s + (uint32_t)i * camada->periodo_s;
+        int idade = t <= camada->inicio_s ? (int)((camada->inicio_s - t) / camada->periodo_s) : -1;
+        const Agregado_t *agregado = &vazio;
+        if (idade >= 0 && idade < camada->preenchidos) {
+            agregado = &historico->agregados[camada->base + (camada->atual + camada->capacidade - idade) % camada->capacidade];
+        }
+        int16_t media = agregado->contagem ? (int16_t)(agregado->soma / (int32_t)agregado->contagem) : 0;
+        p = historico_escrever32(p, agregado->contagem);
+        p = historico_escrever16(p, (uint16_t)agregado->minimo);
+        p = historico_escrever16(p, (uint16_t)agregado->maximo);
+        p = historico_escrever16(p, (uint16_t)media);
+        p = historico_escrever16(p, (uint16_t)agregado->ultimo);
+    }
+    return (int)(p - saida);
+}
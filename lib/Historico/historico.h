@@ -0,0 +1,70 @@
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ---------- Dimensionamento (fixo em tempo de compilação) ---------- */
+#define HISTORICO_MINUTOS          120   // 2 horas em resolução de 1 minuto
+#define HISTORICO_HORAS            72    // 3 dias em resolução de 1 hora
+#define HISTORICO_DIAS             30    // 30 dias em resolução de 1 dia
+#define HISTORICO_ORCAMENTO_BYTES  4096  // RAM máxima de Historico_t
+
+/* ---------- Tipos ---------- */
+typedef enum {
+    HISTORICO_MINUTO,
+    HISTORICO_HORA,
+    HISTORICO_DIA,
+    NUM_NIVEIS_HISTORICO
+} NivelHistorico_t;
+
+// Agregado de um intervalo, em centésimos de °C
+typedef struct {
+    int32_t  soma;              // Soma das leituras (média = soma / contagem)
+    int16_t  minimo, maximo;
+    int16_t  ultimo;            // Leitura mais recente do intervalo
+    uint32_t contagem;          // Leituras no intervalo (0 = sem dados)
+} Agregado_t;
+
+// Sem ponteiros: o histórico inteiro pode ser copiado ou gravado como está
+typedef struct {
+    uint16_t base;              // Primeira posição da camada em Historico_t.agregados
+    uint16_t capacidade;
+    uint16_t atual;             // Posição do intervalo atual no anel da camada
+    uint16_t preenchidos;       // Intervalos já iniciados (até a capacidade)
+    uint32_t periodo_s;
+    uint32_t inicio_s;          // Início do intervalo atual
+} Camada_t;
+
+typedef struct {
+    Camada_t camadas[NUM_NIVEIS_HISTORICO];
+    Agregado_t agregados[HISTORICO_MINUTOS + HISTORICO_HORAS + HISTORICO_DIAS]; // Anéis das camadas em sequência
+} Historico_t;
+
+/* ---------- Funções ---------- */
+//Zera todas as camadas; os intervalos ficam alinhados a múltiplos do período desde tempo_s
+void historico_iniciar(Historico_t *historico, uint32_t tempo_s);
+//Soma a leitura ao intervalo atual de cada camada, fechando os que já terminaram (O(1) amortizado)
+void historico_registrar(Historico_t *historico, float temperatura, uint32_t tempo_s);
+//Intervalos disponíveis na camada, contando o atual
+int historico_quantidade(const Historico_t *historico, NivelHistorico_t nivel);
+//Copia o intervalo 'idade' da camada (0 = atual, 1 = anterior...); false se não existir
+bool historico_ler(const Historico_t *historico, NivelHistorico_t nivel, int idade, Agregado_t *agregado, uint32_t *inicio_s);
+//Duração de um intervalo da camada (s)
+uint32_t historico_periodo_s(NivelHistorico_t nivel);
+//Média do agregado em °C (NAN se vazio)
+float historico_media(const Agregado_t *agregado);
+
+/* ---------- Codificação binária (consultas remotas) ---------- */
+#define HISTORICO_BYTES_REGISTRO   12    // contagem u32, mínimo, máximo, média e última i16 (centésimos), little-endian
+
+//Intervalos da camada com início em [inicio_s, fim_s) ainda no anel; *primeiro_s recebe o início do primeiro
+int historico_contar(const Historico_t *historico, NivelHistorico_t nivel, uint32_t inicio_s, uint32_t fim_s, uint32_t *primeiro_s);
+//Codifica 'quantidade' intervalos consecutivos a partir de inicio_s (alinhado ao período) direto do anel
+//para 'saida'; intervalos já sobrescritos saem com contagem 0. Retorna os bytes escritos
+int historico_codificar(const Historico_t *historico, NivelHistorico_t nivel, uint32_t inicio_s, int quantidade, uint8_t *saida);
+//Escreve um inteiro little-endian em p; retorna a posição seguinte (também para o cabeçalho das páginas)
+uint8_t *historico_escrever16(uint8_t *p, uint16_t valor);
+uint8_t *historico_escrever32(uint8_t *p, uint32_t valor);
+
+#endif /* HISTORICO_H */
@@ -0,0 +1,79 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "log.h"
+
+/* Fila limitada de vários produtores e um consumidor (esquema de Vyukov): cada posição tem
+ * um número de sequência que diz se ela está livre para a volta 'pos' (seq == pos) ou pronta
+ * para leitura (seq == pos + 1). O produtor reserva a posição com um CAS na cauda e formata
+ * direto nela; o consumidor só lê posições publicadas. No Cortex-M0+ o CAS vem do pico_atomic
+ * do SDK, que o faz sob um spinlock de hardware por poucas instruções */
+typedef struct {
+    volatile uint32_t sequencia;
+    MensagemLog_t mensagem;
+} PosicaoLog_t;
+
+_Static_assert((LOG_CAPACIDADE & (LOG_CAPACIDADE - 1)) == 0, "LOG_CAPACIDADE deve ser potência de 2");
+
+static PosicaoLog_t posicoes[LOG_CAPACIDADE];
+static uint32_t cauda;                     // Próxima posição a reservar (produtores)
+static uint32_t cabeca;                    // Próxima posição a ler (só o consumidor)
+static ContadoresLog_t contadores;
+static uint32_t (*relogio)(void);
+
+void log_iniciar(uint32_t (*relogio_ms)(void)) {
+    memset(&contadores, 0, sizeof(contadores));
+    for (uint32_t i = 0; i < LOG_CAPACIDADE; i++) posicoes[i].sequencia = i;
+    cauda = cabeca = 0;
+    relogio = relogio_ms;
+}
+
+void log_escrever(uint8_t nivel, const char *formato, ...) {
+    uint32_t pos = __atomic_load_n(&cauda, __ATOMIC_RELAXED);
+    PosicaoLog_t *posicao;
+    while (1) {
+        posicao = &posicoes[pos & (LOG_CAPACIDADE - 1)];
+        int32_t diferenca = (int32_t)(__atomic_load_n(&posicao->sequencia, __ATOMIC_ACQUIRE) - pos);
+        if (diferenca == 0) {
+            if (__atomic_compare_exchange_n(&cauda, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (diferenca < 0) {
+            __atomic_fetch_add(&contadores.descartadas, 1, __ATOMIC_RELAXED); // Anel cheio: nunca espera
+            return;
+        } else {
+            pos = __atomic_load_n(&cauda, __ATOMIC_RELAXED); // Outro produtor levou a posição
+        }
+    }
+
+    MensagemLog_t *mensagem = &posicao->mensagem;
+    mensagem->nivel = nivel;
+    mensagem->marca_ms = relogio ? relogio() : 0;
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int tamanho = vsnprintf(mensagem->texto, sizeof(mensagem->texto), formato, argumentos);
+    va_end(argumentos);
+    if (tamanho >= (int)sizeof(mensagem->texto)) __atomic_fetch_add(&contadores.cortadas, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&contadores.escritas, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&posicao->sequencia, pos + 1, __ATOMIC_RELEASE); // Publica só após formatar
+}
+
+bool log_retirar(MensagemLog_t *mensagem) {
+    PosicaoLog_t *posicao = &posicoes[cabeca & (LOG_CAPACIDADE - 1)];
+    if (__atomic_load_n(&posicao->sequencia, __ATOMIC_ACQUIRE) != cabeca + 1) return false; // Vazia ou ainda sendo formatada
+    *mensagem = posicao->mensagem;
+    __atomic_store_n(&posicao->sequencia, cabeca + LOG_CAPACIDADE, __ATOMIC_RELEASE); // Livre para a próxima volta
+    cabeca++;
+    return true;
+}
+
+ContadoresLog_t log_contadores(void) {
+    ContadoresLog_t copia;
+    copia.escritas = __atomic_load_n(&contadores.escritas, __ATOMIC_RELAXED);
+    copia.descartadas = __atomic_load_n(&contadores.descartadas, __ATOMIC_RELAXED);
+    copia.cortadas = __atomic_load_n(&contadores.cortadas, __ATOMIC_RELAXED);
+    return copia;
+}
+
+const char *log_rotulo(uint8_t nivel) {
+    static const char *const ROTULOS[] = { "-", "E", "A", "I", "D" };
+    return nivel <= LOG_NIVEL_DEPURACAO ? ROTULOS[nivel] : "?";
+}
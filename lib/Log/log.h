@@ -0,0 +1,70 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ---------- Níveis ---------- */
+#define LOG_NIVEL_NENHUM     0
+#define LOG_NIVEL_ERRO       1
+#define LOG_NIVEL_AVISO      2
+#define LOG_NIVEL_INFO       3
+#define LOG_NIVEL_DEPURACAO  4
+
+#ifndef LOG_NIVEL
+#define LOG_NIVEL            LOG_NIVEL_INFO // Níveis acima deste somem na compilação (argumentos nem são avaliados)
+#endif
+
+/* ---------- Dimensionamento ---------- */
+#define LOG_CAPACIDADE       32    // Mensagens no anel (potência de 2)
+#define LOG_TAMANHO_TEXTO    96    // Bytes por mensagem, com o terminador; o excesso é cortado
+
+/* ---------- Tipos ---------- */
+typedef struct {
+    uint32_t marca_ms;              // Momento da chamada (não da impressão)
+    uint8_t  nivel;
+    char     texto[LOG_TAMANHO_TEXTO];
+} MensagemLog_t;
+
+typedef struct {
+    uint32_t escritas;              // Mensagens aceitas no anel
+    uint32_t descartadas;           // Recusadas com o anel cheio
+    uint32_t cortadas;              // Aceitas, mas maiores que LOG_TAMANHO_TEXTO
+} ContadoresLog_t;
+
+/* ---------- Funções ---------- */
+//Esvazia o anel; relogio_ms (opcional) carimba cada mensagem no momento da chamada
+void log_iniciar(uint32_t (*relogio_ms)(void));
+//Formata direto em uma posição do anel, sem travas nem E/S: com o anel cheio a mensagem é
+//descartada e contada. Pode ser chamada de qualquer tarefa, núcleo ou callback do lwIP
+void log_escrever(uint8_t nivel, const char *formato, ...) __attribute__((format(printf, 2, 3)));
+//Retira a mensagem mais antiga já completa (um único consumidor); false se não houver
+bool log_retirar(MensagemLog_t *mensagem);
+//Cópia dos contadores
+ContadoresLog_t log_contadores(void);
+//Rótulo curto do nível ("E", "A", "I", "D")
+const char *log_rotulo(uint8_t nivel);
+
+/* ---------- Macros por nível ---------- */
+#if LOG_NIVEL >= LOG_NIVEL_ERRO
+#define LOG_ERRO(...)        log_escrever(LOG_NIVEL_ERRO, __VA_ARGS__)
+#else
+#define LOG_ERRO(...)        ((void)0)
+#endif
+#if LOG_NIVEL >= LOG_NIVEL_AVISO
+#define LOG_AVISO(...)       log_escrever(LOG_NIVEL_AVISO, __VA_ARGS__)
+#else
+#define LOG_AVISO(...)       ((void)0)
+#endif
+#if LOG_NIVEL >= LOG_NIVEL_INFO
+#define LOG_INFO(...)        log_escrever(LOG_NIVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)        ((void)0)
+#endif
+#if LOG_NIVEL >= LOG_NIVEL_DEPURACAO
+#define LOG_DEPURACAO(...)   log_escrever(LOG_NIVEL_DEPURACAO, __VA_ARGS__)
+#else
+#define LOG_DEPURACAO(...)   ((void)0)
+#endif
+
+#endif /* LOG_H */
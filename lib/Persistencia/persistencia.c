@@ -0,0 +1,174 @@
+#include <string.h>
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "persistencia.h"
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES      (2 * 1024 * 1024)
+#endif
+#define PERSISTENCIA_MARCADOR      0x50455253u // "PERS"
+#define TIMEOUT_FLASH_MS           1000        // Espera para pausar o outro núcleo
+
+typedef struct {
+    uint32_t marcador;
+    uint32_t sequencia;         // Cresce a cada gravação na área
+    uint16_t tamanho;           // Bytes de dados após o cabeçalho
+    uint16_t reservado;
+    uint32_t crc;               // CRC-32 dos dados
+} CabecalhoRegistro_t;
+
+typedef struct {
+    uint32_t deslocamento;      // Em relação ao início da flash
+    const uint8_t *dados;
+} OperacaoFlash_t;
+
+_Static_assert(sizeof(CabecalhoRegistro_t) + PERSISTENCIA_TAMANHO_MAXIMO <= FLASH_SECTOR_SIZE, "Registro maior que um setor");
+
+static const uint8_t SETORES_AREA[NUM_AREAS_PERSISTENCIA] = PERSISTENCIA_SETORES_AREAS;
+static ContadoresPersistencia_t contadores;
+
+uint32_t persistencia_crc32(uint32_t crc, const void *dados, size_t tamanho) {
+    const uint8_t *p = dados;
+    crc = ~crc;
+    while (tamanho--) {
+        crc ^= *p++;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+// As áreas ficam em sequência a partir do fim da flash, a primeira no topo
+static uint32_t inicio_setor(AreaPersistencia_t area, int setor) {
+    uint32_t setores_ate_area = 0;
+    for (int a = 0; a <= (int)area; a++) setores_ate_area += SETORES_AREA[a];
+    return PICO_FLASH_SIZE_BYTES - (setores_ate_area - (uint32_t)setor) * FLASH_SECTOR_SIZE;
+}
+
+// A flash é lida diretamente pelo XIP
+static const uint8_t *na_flash(uint32_t deslocamento) {
+    return (const uint8_t *)(XIP_BASE + deslocamento);
+}
+
+static uint32_t tamanho_posicao(size_t tamanho) {
+    return (sizeof(CabecalhoRegistro_t) + tamanho + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+}
+
+static bool apagada(uint32_t deslocamento, uint32_t tamanho) {
+    const uint8_t *p = na_flash(deslocamento);
+    for (uint32_t i = 0; i < tamanho; i++) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static const CabecalhoRegistro_t *cabecalho_em(uint32_t deslocamento) {
+    return (const CabecalhoRegistro_t *)na_flash(deslocamento);
+}
+
+// Registro íntegro mais recente da área; false se não houver nenhum. Só o candidato de maior
+// sequência tem o CRC conferido; se estiver corrompido, procura o anterior. *maior recebe a maior
+// sequência vista, íntegra ou não, para a próxima gravação ficar acima dela
+static bool localizar(AreaPersistencia_t area, size_t tamanho, int *setor, uint32_t *posicao, uint32_t *sequencia,
+                      uint32_t *maior) {
+    uint32_t passo = tamanho_posicao(tamanho);
+    bool limitado = false;
+    uint32_t limite = 0;
+    while (1) {
+        bool achou = false;
+        for (int s = 0; s < SETORES_AREA[area]; s++) {
+            for (uint32_t p = 0; p + passo <= FLASH_SECTOR_SIZE; p += passo) {
+                const CabecalhoRegistro_t *cabecalho = cabecalho_em(inicio_setor(area, s) + p);
+                if (cabecalho->marcador != PERSISTENCIA_MARCADOR || cabecalho->tamanho != tamanho) continue;
+                if (limitado && (int32_t)(cabecalho->sequencia - limite) >= 0) continue;
+                if (!achou || (int32_t)(cabecalho->sequencia - *sequencia) > 0) {
+                    *setor = s;
+                    *posicao = p;
+                    *sequencia = cabecalho->sequencia;
+                    achou = true;
+                }
+            }
+        }
+        if (!achou) return false;
+        if (!limitado) *maior = *sequencia;
+        uint32_t deslocamento = inicio_setor(area, *setor) + *posicao;
+        if (persistencia_crc32(0, na_flash(deslocamento) + sizeof(CabecalhoRegistro_t), tamanho) == cabecalho_em(deslocamento)->crc) {
+            return true;
+        }
+        limitado = true;
+        limite = *sequencia;
+    }
+}
+
+bool persistencia_ler(AreaPersistencia_t area, void *dados, size_t tamanho) {
+    int setor;
+    uint32_t posicao, sequencia, maior;
+    if (area >= NUM_AREAS_PERSISTENCIA || tamanho > PERSISTENCIA_TAMANHO_MAXIMO) return false;
+    if (!localizar(area, tamanho, &setor, &posicao, &sequencia, &maior)) return false;
+    memcpy(dados, na_flash(inicio_setor(area, setor) + posicao) + sizeof(CabecalhoRegistro_t), tamanho);
+    return true;
+}
+
+// Executadas com o XIP desligado e as interrupções deste núcleo mascaradas
+static void apagar_setor(void *param) {
+    flash_range_erase(((const OperacaoFlash_t *)param)->deslocamento, FLASH_SECTOR_SIZE);
+}
+
+static void programar_pagina(void *param) {
+    const OperacaoFlash_t *operacao = param;
+    flash_range_program(operacao->deslocamento, operacao->dados, FLASH_PAGE_SIZE);
+}
+
+bool persistencia_gravar(AreaPersistencia_t area, const void *dados, size_t tamanho) {
+    if (area >= NUM_AREAS_PERSISTENCIA || tamanho > PERSISTENCIA_TAMANHO_MAXIMO) return false;
+    uint32_t passo = tamanho_posicao(tamanho);
+
+    // Próxima posição limpa depois do registro mais recente (pula restos de gravações interrompidas)
+    int setor = 0;
+    uint32_t posicao = 0, sequencia = 0, maior = 0;
+    bool existe = localizar(area, tamanho, &setor, &posicao, &sequencia, &maior);
+    if (existe) {
+        posicao += passo;
+        sequencia = maior + 1;
+    }
+    uint32_t base = inicio_setor(area, setor);
+    while (posicao + passo <= FLASH_SECTOR_SIZE && !apagada(base + posicao, passo)) posicao += passo;
+    if (posicao + passo > FLASH_SECTOR_SIZE) {
+        // Setor cheio: apaga o próximo, nunca o que guarda o registro atual
+        if (existe) setor = (setor + 1) % SETORES_AREA[area];
+        base = inicio_setor(area, setor);
+        OperacaoFlash_t operacao = { .deslocamento = base };
+        if (flash_safe_execute(apagar_setor, &operacao, TIMEOUT_FLASH_MS) != PICO_OK) return false;
+        contadores.apagamentos++;
+        posicao = 0;
+    }
+
+    // O cabeçalho vai na primeira página, programada por último: o registro só passa a valer
+    // depois que todos os dados estão na flash
+    CabecalhoRegistro_t cabecalho = {
+        .marcador = PERSISTENCIA_MARCADOR,
+        .sequencia = sequencia,
+        .tamanho = (uint16_t)tamanho,
+        .crc = persistencia_crc32(0, dados, tamanho),
+    };
+    uint8_t pagina[FLASH_PAGE_SIZE];
+    for (int32_t p = (int32_t)(passo / FLASH_PAGE_SIZE) - 1; p >= 0; p--) {
+        memset(pagina, 0xFF, sizeof(pagina));
+        uint32_t inicio = (uint32_t)p * FLASH_PAGE_SIZE; // Posição da página dentro do registro
+        uint32_t origem = inicio ? inicio - sizeof(cabecalho) : 0;
+        uint8_t *destino = pagina;
+        if (p == 0) {
+            memcpy(pagina, &cabecalho, sizeof(cabecalho));
+            destino += sizeof(cabecalho);
+        }
+        uint32_t disponivel = FLASH_PAGE_SIZE - (uint32_t)(destino - pagina);
+        if (origem < tamanho) memcpy(destino, (const uint8_t *)dados + origem, MIN(disponivel, tamanho - origem));
+        OperacaoFlash_t operacao = { .deslocamento = base + posicao + inicio, .dados = pagina };
+        if (flash_safe_execute(programar_pagina, &operacao, TIMEOUT_FLASH_MS) != PICO_OK) return false;
+    }
+    contadores.gravacoes++;
+    return true;
+}
+
+ContadoresPersistencia_t persistencia_contadores(void) {
+    return contadores;
+}
@@ -0,0 +1,42 @@
+#ifndef PERSISTENCIA_H
+#define PERSISTENCIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- Áreas (setores de 4 KB, a partir do fim da flash) ---------- */
+// Novas áreas entram no fim da lista: as existentes não mudam de endereço
+typedef enum {
+    AREA_REDE,                  // Último AP, concessão DHCP e endereço do broker
+    AREA_RETOMADA,              // Ajustes e estado dos previsores (gravado a cada minuto)
+    NUM_AREAS_PERSISTENCIA
+} AreaPersistencia_t;
+
+/* ---------- Dimensionamento ---------- */
+// Setores de cada área, na ordem acima (no mínimo 2: o registro atual sobrevive ao apagamento
+// do próximo setor). Mais setores dividem o desgaste de uma área gravada com frequência
+#define PERSISTENCIA_SETORES_AREAS     { 2, 32 }
+#define PERSISTENCIA_TAMANHO_MAXIMO    2048  // Bytes de dados por registro
+
+/* Cada gravação ocupa a próxima posição livre do setor atual (múltiplo de uma página de 256 B);
+ * com o setor cheio, o próximo da área é apagado e recebe o registro. A leitura escolhe o
+ * registro íntegro (marcador, tamanho e CRC-32) de maior sequência, então uma queda de energia
+ * no meio de uma gravação só perde o registro sendo gravado */
+typedef struct {
+    uint32_t gravacoes;         // Registros gravados desde o boot
+    uint32_t apagamentos;       // Setores apagados desde o boot
+} ContadoresPersistencia_t;
+
+/* ---------- Funções ---------- */
+//Copia o registro mais recente da área para 'dados'; false se não houver um íntegro de 'tamanho' bytes
+bool persistencia_ler(AreaPersistencia_t area, void *dados, size_t tamanho);
+//Grava um novo registro na área. Pausa o XIP (e o outro núcleo no perfil SMP) durante a programação:
+//não chamar de interrupções nem de callbacks do lwIP. Gravações na mesma área não podem ser concorrentes
+bool persistencia_gravar(AreaPersistencia_t area, const void *dados, size_t tamanho);
+//Cópia dos contadores
+ContadoresPersistencia_t persistencia_contadores(void);
+//CRC-32 (IEEE 802.3) de um bloco; 'crc' = 0 no primeiro bloco, o resultado anterior nos seguintes
+uint32_t persistencia_crc32(uint32_t crc, const void *dados, size_t tamanho);
+
+#endif /* PERSISTENCIA_H */
@@ -0,0 +1,58 @@
+#include <math.h>
+#include <string.h>
+#include "calibracao.h"
+
+void calibracao_iniciar(CalibracaoLinear_t *calibracao, const ParametrosPrevisao_t *parametros) {
+    memset(calibracao, 0, sizeof(*calibracao));
+    calibracao->cobertura_alvo = erff(parametros->z_intervalo / sqrtf(2.0f));
+}
+
+void calibracao_retomar(CalibracaoLinear_t *calibracao, const ParametrosPrevisao_t *parametros) {
+    calibracao->cobertura_alvo = erff(parametros->z_intervalo / sqrtf(2.0f));
+}
+
+void calibracao_deslocar_tempo(CalibracaoLinear_t *calibracao, float deslocamento_s) {
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        for (int i = 0; i < CALIBRACAO_PENDENTES; i++) calibracao->pendentes[h][i].alvo_s += deslocamento_s;
+        calibracao->proximo_registro_s[h] += deslocamento_s;
+    }
+}
+
+float calibracao_fator(const CalibracaoLinear_t *calibracao, int h) {
+    return expf(calibracao->log_fator[h]);
+}
+
+void calibracao_aplicar(CalibracaoLinear_t *calibracao, const ParametrosPrevisao_t *parametros, float tempo_s,
+                        float temperatura, ResultadosPrevisao_t *resultados) {
+    const float log_minimo = logf(CALIBRACAO_FATOR_MIN), log_maximo = logf(CALIBRACAO_FATOR_MAX);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        PrevisaoPendente_t *anel = calibracao->pendentes[h];
+
+        // Até a primeira avaliação, herda o fator do horizonte mais curto (já calibrado antes)
+        if (h > 0 && calibracao->avaliacoes[h] == 0) calibracao->log_fator[h] = calibracao->log_fator[h - 1];
+
+        // Previsões cujo alvo chegou: a leitura atual é o valor real
+        while (calibracao->quantidade[h] && anel[calibracao->inicio[h]].alvo_s <= tempo_s) {
+            const PrevisaoPendente_t *pendente = &anel[calibracao->inicio[h]];
+            bool fora = fabsf(temperatura - pendente->previsao) > pendente->margem * calibracao_fator(calibracao, h);
+            float ganho = fmaxf(1.0f / (1.0f + calibracao->avaliacoes[h]), CALIBRACAO_GANHO_MIN);
+            float log_fator = calibracao->log_fator[h] + ganho * ((fora ? 1.0f : 0.0f) - (1.0f - calibracao->cobertura_alvo));
+            calibracao->log_fator[h] = fminf(fmaxf(log_fator, log_minimo), log_maximo);
+            calibracao->avaliacoes[h]++;
+            calibracao->fora[h] += fora;
+            calibracao->inicio[h] = (calibracao->inicio[h] + 1) % CALIBRACAO_PENDENTES;
+            calibracao->quantidade[h]--;
+        }
+
+        // Guarda a previsão atual se já passou o espaçamento (sem margem, a regressão ainda não existe)
+        float margem = resultados->margem_linear[h];
+        if (margem > 0 && tempo_s >= calibracao->proximo_registro_s[h] && calibracao->quantidade[h] < CALIBRACAO_PENDENTES) {
+            int posicao = (calibracao->inicio[h] + calibracao->quantidade[h]) % CALIBRACAO_PENDENTES;
+            anel[posicao] = (PrevisaoPendente_t){ .alvo_s = tempo_s + parametros->horizontes_s[h],
+                                                  .previsao = resultados->previsao_linear[h], .margem = margem };
+            calibracao->quantidade[h]++;
+            calibracao->proximo_registro_s[h] = tempo_s + parametros->horizontes_s[h] / CALIBRACAO_PENDENTES;
+        }
+        resultados->margem_linear[h] = margem * calibracao_fator(calibracao, h);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef CALIBRACAO_H
+#define CALIBRACAO_H
+
+#include <stdint.h>
+#include "previsao.h"
+
+/* ---------- Parâmetros ---------- */
+#define CALIBRACAO_PENDENTES    16     // Previsões guardadas por horizonte à espera do valor real
+#define CALIBRACAO_GANHO_MIN    0.1f   // Passo mínimo do ajuste do fator (em log), depois das primeiras avaliações
+#define CALIBRACAO_FATOR_MIN    0.25f  // Limites do fator aplicado à margem da regressão
+#define CALIBRACAO_FATOR_MAX    256.0f
+
+/* ---------- Tipos ---------- */
+typedef struct {
+    float alvo_s;               // Instante previsto
+    float previsao;
+    float margem;               // Margem da regressão, sem o fator
+} PrevisaoPendente_t;
+
+/* A margem da regressão supõe resíduos independentes, o que a série filtrada não tem: sozinha,
+ * cobre bem menos que o nominal de z_intervalo. Cada horizonte guarda algumas previsões até o
+ * instante alvo e compara com a leitura do sensor que chega nele; o fator da margem sobe a cada
+ * valor fora e desce a cada valor dentro, na proporção que converge para a cobertura nominal
+ * (erf(z/√2), rastreamento de quantil). O passo começa grande e cai até CALIBRACAO_GANHO_MIN;
+ * até a primeira avaliação, um horizonte usa o fator do anterior */
+typedef struct {
+    PrevisaoPendente_t pendentes[NUM_HORIZONTES][CALIBRACAO_PENDENTES]; // Anel por horizonte, em ordem de alvo
+    uint8_t  inicio[NUM_HORIZONTES], quantidade[NUM_HORIZONTES];
+    float    proximo_registro_s[NUM_HORIZONTES]; // Uma previsão guardada a cada horizonte / CALIBRACAO_PENDENTES
+    float    log_fator[NUM_HORIZONTES];
+    uint32_t avaliacoes[NUM_HORIZONTES];   // Previsões comparadas com o valor real
+    uint32_t fora[NUM_HORIZONTES];         // Das avaliadas, as que caíram fora do intervalo calibrado
+    float    cobertura_alvo;               // Fração nominal dentro do intervalo
+} CalibracaoLinear_t;
+
+/* ---------- Funções ---------- */
+//Zera o estado (fator 1 em todos os horizontes)
+void calibracao_iniciar(CalibracaoLinear_t *calibracao, const ParametrosPrevisao_t *parametros);
+//Aplica os parâmetros atuais a um estado restaurado (a cobertura nominal segue z_intervalo)
+void calibracao_retomar(CalibracaoLinear_t *calibracao, const ParametrosPrevisao_t *parametros);
+//Soma 'deslocamento_s' aos instantes guardados, como previsao_deslocar_tempo
+void calibracao_deslocar_tempo(CalibracaoLinear_t *calibracao, float deslocamento_s);
+//Avalia as previsões guardadas cujo alvo chegou contra 'temperatura' (leitura do sensor em 'tempo_s'),
+//guarda as novas e multiplica resultados->margem_linear pelo fator de cada horizonte
+void calibracao_aplicar(CalibracaoLinear_t *calibracao, const ParametrosPrevisao_t *parametros, float tempo_s,
+                        float temperatura, ResultadosPrevisao_t *resultados);
+//Fator atual da margem da regressão no horizonte h
+float calibracao_fator(const CalibracaoLinear_t *calibracao, int h);
+
+#endif /* CALIBRACAO_H */
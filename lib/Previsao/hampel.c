@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include <string.h>
+#include "hampel.h"
+
+#define PESO_ESCALA_BITS 4 // Peso 1/16 do desvio novo na escala
+
+void hampel_parametros_padrao(ParametrosHampel_t *parametros) {
+    parametros->janela = HAMPEL_JANELA;
+    parametros->k = HAMPEL_K;
+    parametros->limiar_minimo = HAMPEL_LIMIAR_MINIMO;
+}
+
+void hampel_iniciar(FiltroHampel_t *filtro, const ParametrosHampel_t *parametros) {
+    memset(filtro, 0, sizeof(*filtro));
+    filtro->parametros = *parametros;
+    int janela = filtro->parametros.janela | 1;
+    if (janela > HAMPEL_JANELA_MAX) janela = HAMPEL_JANELA_MAX;
+    if (janela < 3) janela = 3;
+    filtro->parametros.janela = janela;
+    filtro->fator_q8 = (int32_t)(parametros->k * 1.4826f * 256 + 0.5f);
+}
+
+//Verdadeiro se o índice a deve ficar acima de b na heap (maior na inferior, menor na superior)
+static bool acima(const FiltroHampel_t *filtro, bool inferior, uint8_t a, uint8_t b) {
+    return inferior ? filtro->valores[a] > filtro->valores[b] : filtro->valores[a] < filtro->valores[b];
+}
+
+static void trocar(FiltroHampel_t *filtro, uint8_t *heap, int i, int j) {
+    uint8_t temp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = temp;
+    filtro->posicao[heap[i]] = i;
+    filtro->posicao[heap[j]] = j;
+}
+
+static int subir(FiltroHampel_t *filtro, bool inferior, int i) {
+    uint8_t *heap = inferior ? filtro->inferior : filtro->superior;
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!acima(filtro, inferior, heap[i], heap[pai])) break;
+        trocar(filtro, heap, i, pai);
+        i = pai;
+    }
+    return i;
+}
+
+static void descer(FiltroHampel_t *filtro, bool inferior, int i) {
+    uint8_t *heap = inferior ? filtro->inferior : filtro->superior;
+    int n = inferior ? filtro->n_inferior : filtro->n_superior;
+    while (1) {
+        int escolhido = i;
+        for (int filho = 2 * i + 1; filho <= 2 * i + 2 && filho < n; filho++) {
+            if (acima(filtro, inferior, heap[filho], heap[escolhido])) escolhido = filho;
+        }
+        if (escolhido == i) return;
+        trocar(filtro, heap, i, escolhido);
+        i = escolhido;
+    }
+}
+
+//Garante máximo(inferior) <= mínimo(superior) trocando os topos; basta uma troca por leitura
+static void equilibrar_topos(FiltroHampel_t *filtro) {
+    if (!filtro->n_inferior || !filtro->n_superior) return;
+    uint8_t a = filtro->inferior[0], b = filtro->superior[0];
+    if (filtro->valores[a] <= filtro->valores[b]) return;
+    filtro->inferior[0] = b;
+    filtro->superior[0] = a;
+    filtro->na_inferior[b] = true;
+    filtro->na_inferior[a] = false;
+    filtro->posicao[a] = filtro->posicao[b] = 0;
+    descer(filtro, true, 0);
+    descer(filtro, false, 0);
+}
+
+//Põe a leitura na janela: enquanto enche, alterna entre as heaps; cheia, sobrescreve a mais antiga
+static void inserir(FiltroHampel_t *filtro, int16_t valor) {
+    int ocupadas = filtro->n_inferior + filtro->n_superior;
+    if (ocupadas < filtro->parametros.janela) {
+        bool inferior = filtro->n_inferior == filtro->n_superior;
+        uint8_t *heap = inferior ? filtro->inferior : filtro->superior;
+        int *n = inferior ? &filtro->n_inferior : &filtro->n_superior;
+        filtro->valores[ocupadas] = valor;
+        filtro->na_inferior[ocupadas] = inferior;
+        heap[*n] = (uint8_t)ocupadas;
+        filtro->posicao[ocupadas] = (uint8_t)*n;
+        subir(filtro, inferior, (*n)++);
+    } else {
+        int indice = filtro->mais_antigo;
+        bool inferior = filtro->na_inferior[indice];
+        filtro->valores[indice] = valor;
+        int posicao = filtro->posicao[indice];
+        if (subir(filtro, inferior, posicao) == posicao) descer(filtro, inferior, posicao);
+        filtro->mais_antigo = (indice + 1) % filtro->parametros.janela;
+    }
+    equilibrar_topos(filtro);
+}
+
+ResultadoHampel_t hampel_filtrar(FiltroHampel_t *filtro, int16_t bruto, int16_t *saida) {
+    int ocupadas = filtro->n_inferior + filtro->n_superior;
+    int16_t mediana = ocupadas ? filtro->valores[filtro->inferior[0]] : bruto;
+
+    // 85 °C do power-on não é leitura: nunca entra na janela
+    if (bruto == DS18B20_VALOR_RESET) {
+        filtro->contadores.valor_reset++;
+        if (!ocupadas) return HAMPEL_DESCARTADA;
+        *saida = mediana;
+        return HAMPEL_SUBSTITUIDA;
+    }
+    if (ocupadas < 3) { // Poucas leituras para julgar
+        inserir(filtro, bruto);
+        filtro->contadores.aceitas++;
+        *saida = bruto;
+        return HAMPEL_ACEITA;
+    }
+
+    int32_t desvio = abs(bruto - mediana);
+    int32_t limiar = (filtro->fator_q8 * filtro->escala_q8) >> 16;
+    if (limiar < filtro->parametros.limiar_minimo) limiar = filtro->parametros.limiar_minimo;
+    bool discrepante = desvio > limiar;
+    // Escala atualizada com o desvio limitado ao limiar, para que um pico não a infle
+    int32_t limitado = discrepante ? limiar : desvio;
+    filtro->escala_q8 += ((limitado << 8) - filtro->escala_q8) >> PESO_ESCALA_BITS;
+    inserir(filtro, bruto);
+
+    if (discrepante) {
+        filtro->contadores.discrepantes++;
+        *saida = mediana;
+        return HAMPEL_SUBSTITUIDA;
+    }
+    filtro->contadores.aceitas++;
+    *saida = bruto;
+    return HAMPEL_ACEITA;
+}
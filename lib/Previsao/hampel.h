@@ -0,0 +1,59 @@
+#ifndef HAMPEL_H
+#define HAMPEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ---------- Parâmetros padrão do firmware ---------- */
+#define HAMPEL_JANELA_MAX           15    // Maior janela aceita (ímpar)
+#define HAMPEL_JANELA               7     // Leituras anteriores que formam a mediana
+#define HAMPEL_K                    3.0f  // Limiar em desvios robustos (1,4826 * desvio absoluto médio)
+#define HAMPEL_LIMIAR_MINIMO        8     // Limiar mínimo em 1/16 °C (0,5 °C); o DS18B20 quantiza em 1/16
+#define DS18B20_VALOR_RESET         0x0550 // 85 °C: scratchpad do DS18B20 antes da primeira conversão
+
+/* ---------- Tipos ---------- */
+typedef struct {
+    int   janela;               // Tamanho da janela (ímpar, 3..HAMPEL_JANELA_MAX)
+    float k;                    // Limiar em desvios robustos
+    int16_t limiar_minimo;      // Limiar mínimo (1/16 °C)
+} ParametrosHampel_t;
+
+typedef struct {
+    uint32_t aceitas;           // Leituras repassadas sem alteração
+    uint32_t discrepantes;      // Leituras longe da mediana, trocadas por ela
+    uint32_t valor_reset;       // Leituras de 85 °C do power-on descartadas
+} ContadoresHampel_t;
+
+typedef enum {
+    HAMPEL_ACEITA,              // Saída = leitura
+    HAMPEL_SUBSTITUIDA,         // Saída = mediana da janela
+    HAMPEL_DESCARTADA           // Sem saída: leitura inválida e janela vazia
+} ResultadoHampel_t;
+
+/* Janela deslizante em duas heaps indexadas (máximo da metade inferior e mínimo da
+ * superior). A leitura nova ocupa o lugar da mais antiga na mesma heap, então cada
+ * passo custa O(log janela) e a mediana é o topo da heap inferior */
+typedef struct {
+    ParametrosHampel_t parametros;
+    int32_t fator_q8;                       // k * 1,4826 em Q8
+    int16_t valores[HAMPEL_JANELA_MAX];     // Leituras da janela, por idade (circular)
+    uint8_t inferior[HAMPEL_JANELA_MAX];    // Heap de máximo: índices em valores
+    uint8_t superior[HAMPEL_JANELA_MAX];    // Heap de mínimo: índices em valores
+    uint8_t posicao[HAMPEL_JANELA_MAX];     // Posição de cada índice na sua heap
+    bool    na_inferior[HAMPEL_JANELA_MAX]; // Heap em que cada índice está
+    int     n_inferior, n_superior;
+    int     mais_antigo;                    // Próximo índice a ser substituído
+    int32_t escala_q8;                      // Média exponencial de |leitura - mediana| (1/16 °C em Q8)
+    ContadoresHampel_t contadores;
+} FiltroHampel_t;
+
+/* ---------- Funções ---------- */
+//Preenche os parâmetros com os valores usados pelo firmware
+void hampel_parametros_padrao(ParametrosHampel_t *parametros);
+//Zera a janela e os contadores; a janela é ajustada para ímpar em 3..HAMPEL_JANELA_MAX
+void hampel_iniciar(FiltroHampel_t *filtro, const ParametrosHampel_t *parametros);
+//Compara a leitura bruta (1/16 °C) com a mediana das anteriores e escreve em *saida o valor a usar.
+//Discrepantes entram na janela mesmo assim, para que um degrau real seja aceito após meia janela
+ResultadoHampel_t hampel_filtrar(FiltroHampel_t *filtro, int16_t bruto, int16_t *saida);
+
+#endif /* HAMPEL_H */
@@ -0,0 +1,224 @@
+#include <math.h>
+#include <string.h>
+#include "previsao.h"
+
+void previsao_parametros_padrao(ParametrosPrevisao_t *parametros, float intervalo_leitura_s) {
+    parametros->alpha_holt = ALPHA_HOLT;
+    parametros->beta_holt = BETA_HOLT;
+    parametros->alfa_filtro = ALFA_FILTRO_EMA;
+    parametros->tamanho_historico = TAMANHO_HISTORICO_TEMP;
+    static const float horizontes[NUM_HORIZONTES] = HORIZONTES_PREVISAO_S;
+    for (int h = 0; h < NUM_HORIZONTES; h++) parametros->horizontes_s[h] = horizontes[h];
+    parametros->intervalo_leitura_s = intervalo_leitura_s;
+    parametros->lambda_variancia = LAMBDA_VARIANCIA_HOLT;
+    parametros->z_intervalo = Z_INTERVALO_PREVISAO;
+}
+
+void previsao_fatores_holt(const ParametrosPrevisao_t *parametros, float fatores[NUM_HORIZONTES]) {
+    // Var(h) = Var(1) * (1 + soma_{j=1}^{h-1} (alfa * (1 + beta * j))^2)
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        int passos_adiantados = (int)(parametros->horizontes_s[h] / parametros->intervalo_leitura_s);
+        float soma = 1.0f;
+        for (int j = 1; j < passos_adiantados; j++) {
+            float c = parametros->alpha_holt * (1.0f + parametros->beta_holt * j);
+            soma += c * c;
+        }
+        fatores[h] = sqrtf(soma);
+    }
+}
+
+static int janela_limitada(int tamanho_historico) {
+    if (tamanho_historico > TAMANHO_HISTORICO_MAX) return TAMANHO_HISTORICO_MAX;
+    return tamanho_historico < 2 ? 2 : tamanho_historico;
+}
+
+static void aplicar_parametros(Previsor_t *previsor, const ParametrosPrevisao_t *parametros) {
+    previsor->parametros = *parametros;
+    previsor->parametros.tamanho_historico = janela_limitada(parametros->tamanho_historico);
+    previsao_fatores_holt(&previsor->parametros, previsor->fatores_holt);
+}
+
+void previsao_iniciar(Previsor_t *previsor, const ParametrosPrevisao_t *parametros) {
+    memset(previsor, 0, sizeof(*previsor));
+    aplicar_parametros(previsor, parametros);
+}
+
+bool previsao_retomar(Previsor_t *previsor, const ParametrosPrevisao_t *parametros) {
+    // Outra janela muda o anel do histórico e as somas: o estado não serve
+    if (janela_limitada(parametros->tamanho_historico) != previsor->parametros.tamanho_historico) return false;
+    aplicar_parametros(previsor, parametros);
+    return true;
+}
+
+void previsao_deslocar_tempo(Previsor_t *previsor, float deslocamento_s) {
+    // As somas são relativas a base_tempo e não mudam
+    for (int i = 0; i < previsor->parametros.tamanho_historico; i++) previsor->historico_tempo[i] += deslocamento_s;
+    previsor->base_tempo += deslocamento_s;
+}
+
+bool calcular_regressao(const float *x, const float *y, int n, float *m, float *b) {
+    if (n < 2) {
+        *m = 0;
+        *b = (n ? y[0] : 0);
+        return false;
+    }
+    float soma_x = 0, soma_y = 0, soma_xy = 0, soma_x2 = 0;
+    for (int i = 0; i < n; i++) {
+        soma_x += x[i];
+        soma_y += y[i];
+        soma_xy += x[i] * y[i];
+        soma_x2 += x[i] * x[i];
+    }
+    float denominador = n * soma_x2 - soma_x * soma_x;
+    if (fabsf(denominador) < 1e-6) {
+        *m = 0;
+        *b = soma_y / n;
+        return false;
+    }
+    *m = (n * soma_xy - soma_x * soma_y) / denominador;
+    *b = (soma_y - *m * soma_x) / n;
+    return true;
+}
+
+//Recalcula as somas com a base na leitura mais recente; limita o erro acumulado por somar e subtrair
+static void reancorar_somas(Previsor_t *previsor, int n, int mais_recente) {
+    previsor->base_tempo = previsor->historico_tempo[mais_recente];
+    previsor->base_temp = previsor->historico_temperatura[mais_recente];
+    previsor->soma_x = previsor->soma_y = previsor->soma_xy = previsor->soma_x2 = previsor->soma_y2 = 0;
+    for (int i = 0; i < n; i++) {
+        float x = previsor->historico_tempo[i] - previsor->base_tempo;
+        float y = previsor->historico_temperatura[i] - previsor->base_temp;
+        previsor->soma_x += x;
+        previsor->soma_y += y;
+        previsor->soma_xy += x * y;
+        previsor->soma_x2 += x * x;
+        previsor->soma_y2 += y * y;
+    }
+    previsor->insercoes_desde_base = 0;
+}
+
+static void acumular_somas(Previsor_t *previsor, float tempo, float temp, float sinal) {
+    float x = tempo - previsor->base_tempo;
+    float y = temp - previsor->base_temp;
+    previsor->soma_x += sinal * x;
+    previsor->soma_y += sinal * y;
+    previsor->soma_xy += sinal * x * y;
+    previsor->soma_x2 += sinal * x * x;
+    previsor->soma_y2 += sinal * y * y;
+}
+
+//Avalia a reta das somas em cada horizonte com a margem pelo erro padrão de previsão:
+//s * sqrt(1 + 1/n + (x0 - média x)^2 / Sxx), s^2 = soma dos resíduos^2 / (n - 2)
+static void prever_linear(const Previsor_t *previsor, float tempo_atual, float temp_atual, ResultadosPrevisao_t *resultados) {
+    float *previsoes = resultados->previsao_linear, *margens = resultados->margem_linear;
+    int n = previsor->historico_preenchido ? previsor->parametros.tamanho_historico : previsor->indice_historico;
+    float media_x = n ? previsor->soma_x / n : 0;
+    float media_y = n ? previsor->soma_y / n : 0;
+    float sxx = previsor->soma_x2 - previsor->soma_x * media_x;
+    if (n < 2 || n * sxx < 1e-6f) {
+        for (int h = 0; h < NUM_HORIZONTES; h++) {
+            previsoes[h] = temp_atual;
+            margens[h] = 0;
+        }
+        resultados->nivel_linear = temp_atual;
+        resultados->inclinacao_linear = 0;
+        return;
+    }
+    float sxy = previsor->soma_xy - previsor->soma_x * media_y;
+    float syy = previsor->soma_y2 - previsor->soma_y * media_y;
+    float inclinacao = sxy / sxx;
+    float variancia = n > 2 ? fmaxf(syy - inclinacao * sxy, 0.0f) / (n - 2) : 0.0f;
+    resultados->nivel_linear = previsor->base_temp + media_y + inclinacao * (tempo_atual - previsor->base_tempo - media_x);
+    resultados->inclinacao_linear = inclinacao;
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        float dx = tempo_atual + previsor->parametros.horizontes_s[h] - previsor->base_tempo - media_x;
+        previsoes[h] = previsor->base_temp + media_y + inclinacao * dx;
+        margens[h] = previsor->parametros.z_intervalo * sqrtf(variancia * (1.0f + 1.0f / n + dx * dx / sxx));
+    }
+}
+
+//Holt com espaçamento irregular: a previsão anterior avança 'passos' períodos e a variação do nível
+//vira tendência por período. Com passos = 1 é o Holt clássico
+void previsao_atualizar_holt(Previsor_t *previsor, float temp, float passos, float previsoes[NUM_HORIZONTES],
+                             float margens[NUM_HORIZONTES]) {
+    const ParametrosPrevisao_t *p = &previsor->parametros;
+    float estimado = previsor->nivel + previsor->tendencia * passos;
+    if (!previsor->holt_iniciado) {
+        previsor->nivel = estimado = temp;
+        previsor->tendencia = 0;
+        previsor->holt_iniciado = true;
+    } else {
+        // Erro da previsão feita na leitura anterior para este instante
+        float erro = temp - estimado;
+        if (!previsor->variancia_iniciada) {
+            previsor->variancia_holt = erro * erro;
+            previsor->variancia_iniciada = true;
+        } else {
+            previsor->variancia_holt += p->lambda_variancia * (erro * erro - previsor->variancia_holt);
+        }
+    }
+    float nivel_anterior = previsor->nivel;
+    previsor->nivel = p->alpha_holt * temp + (1 - p->alpha_holt) * estimado;
+    previsor->tendencia = p->beta_holt * (previsor->nivel - nivel_anterior) / passos + (1 - p->beta_holt) * previsor->tendencia;
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        int passos_adiantados = (int)(p->horizontes_s[h] / p->intervalo_leitura_s);
+        previsoes[h] = previsor->nivel + previsor->tendencia * passos_adiantados;
+    }
+    float desvio = sqrtf(previsor->variancia_holt);
+    for (int h = 0; h < NUM_HORIZONTES; h++) margens[h] = p->z_intervalo * desvio * previsor->fatores_holt[h];
+}
+
+float previsao_tempo_ate_limite(float nivel, float inclinacao, float limite) {
+    if (nivel >= limite) return 0.0f;
+    if (inclinacao <= 0.0f) return ETA_NUNCA;
+    float segundos = (limite - nivel) / inclinacao;
+    return segundos <= ETA_MAXIMO_S ? segundos : ETA_NUNCA;
+}
+
+bool previsao_processar(Previsor_t *previsor, float temp, float tempo_s, float *temp_filtrada, ResultadosPrevisao_t *resultados) {
+    const ParametrosPrevisao_t *p = &previsor->parametros;
+    // Filtro exponencial para atenuar ruído
+    if (!previsor->filtro_iniciado) {
+        previsor->temp_filtrada = temp;
+        previsor->filtro_iniciado = true;
+    } else {
+        previsor->temp_filtrada = previsor->temp_filtrada * (1 - p->alfa_filtro) + temp * p->alfa_filtro;
+    }
+    *temp_filtrada = previsor->temp_filtrada;
+    if (!(temp > TEMPERATURA_VALIDA_MIN && temp < TEMPERATURA_VALIDA_MAX)) return false; // Validação da temperatura
+
+    // Períodos nominais desde a leitura anterior (a mais recente do histórico), para o Holt
+    int indice = previsor->indice_historico;
+    float passos = 1.0f;
+    if (previsor->holt_iniciado) {
+        float decorrido = tempo_s - previsor->historico_tempo[(indice + p->tamanho_historico - 1) % p->tamanho_historico];
+        if (decorrido > 0) passos = decorrido / p->intervalo_leitura_s;
+    }
+
+    // Atualiza histórico e somas da regressão: sai a leitura mais antiga, entra a nova
+    if (previsor->historico_preenchido) {
+        acumular_somas(previsor, previsor->historico_tempo[indice], previsor->historico_temperatura[indice], -1.0f);
+    } else if (indice == 0) {
+        previsor->base_tempo = tempo_s;
+        previsor->base_temp = previsor->temp_filtrada;
+    }
+    previsor->historico_temperatura[indice] = previsor->temp_filtrada;
+    previsor->historico_tempo[indice] = tempo_s;
+    acumular_somas(previsor, tempo_s, previsor->temp_filtrada, 1.0f);
+    previsor->indice_historico = (indice + 1) % p->tamanho_historico;
+    if (!previsor->historico_preenchido && previsor->indice_historico == 0) {
+        previsor->historico_preenchido = true;
+    }
+    if (++previsor->insercoes_desde_base >= p->tamanho_historico) {
+        reancorar_somas(previsor, previsor->historico_preenchido ? p->tamanho_historico : previsor->indice_historico, indice);
+    }
+
+    // Suavização Holt
+    previsao_atualizar_holt(previsor, previsor->temp_filtrada, passos, resultados->previsao_holt, resultados->margem_holt);
+    resultados->nivel_holt = previsor->nivel;
+    resultados->inclinacao_holt = previsor->tendencia / p->intervalo_leitura_s;
+
+    // Previsão linear
+    prever_linear(previsor, tempo_s, previsor->temp_filtrada, resultados);
+    return true;
+}
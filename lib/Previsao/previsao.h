@@ -0,0 +1,94 @@
+#ifndef PREVISAO_H
+#define PREVISAO_H
+
+#include <stdbool.h>
+
+/* ---------- Parâmetros padrão do firmware ---------- */
+#define TAMANHO_HISTORICO_TEMP      30    // Tamanho do histórico de temperaturas
+#define INTERVALO_PREVISAO_SEGUNDOS 300   // Intervalo para previsão (segundos)
+#define NUM_HORIZONTES              4     // Previsões calculadas a cada atualização do modelo
+#define HORIZONTES_PREVISAO_S       { 60, INTERVALO_PREVISAO_SEGUNDOS, 900, 3600 } // 1, 5, 15 e 60 min
+#define HORIZONTE_PADRAO            1     // Índice de INTERVALO_PREVISAO_SEGUNDOS (display e tópicos de valor único)
+#define ALPHA_HOLT                  0.3f  // Fator de suavização do nível
+#define BETA_HOLT                   0.1f  // Fator de suavização da tendência
+#define ALFA_FILTRO_EMA             0.2f  // Peso da leitura nova no filtro exponencial
+#define LAMBDA_VARIANCIA_HOLT       0.05f // Peso do erro novo na variância de um passo do Holt
+#define Z_INTERVALO_PREVISAO        1.96f // Meia largura dos intervalos em desvios (~95%)
+#define ETA_NUNCA                   -1.0f // Tempo até o limite quando a tendência não leva a ele
+#define ETA_MAXIMO_S                86400.0f // Tempos maiores que um dia são tratados como ETA_NUNCA
+#define TEMPERATURA_VALIDA_MIN      -20.0f // Leituras fora desta faixa não entram nas previsões
+#define TEMPERATURA_VALIDA_MAX      80.0f
+
+// Maior janela aceita em tempo de execução; o firmware reserva só a janela padrão e
+// as ferramentas de host sobrescrevem para varrer janelas maiores
+#ifndef TAMANHO_HISTORICO_MAX
+#define TAMANHO_HISTORICO_MAX       TAMANHO_HISTORICO_TEMP
+#endif
+
+/* ---------- Tipos ---------- */
+typedef struct {
+    float alpha_holt;           // Fator de suavização do nível
+    float beta_holt;            // Fator de suavização da tendência
+    float alfa_filtro;          // Peso da leitura nova no filtro exponencial
+    int   tamanho_historico;    // Janela da regressão (2..TAMANHO_HISTORICO_MAX)
+    float horizontes_s[NUM_HORIZONTES]; // Distância de cada previsão (segundos)
+    float intervalo_leitura_s;  // Período nominal entre leituras (segundos)
+    float lambda_variancia;     // Peso do erro novo na variância de um passo do Holt
+    float z_intervalo;          // Meia largura dos intervalos em desvios-padrão
+} ParametrosPrevisao_t;
+
+// Intervalo de cada previsão: [previsao - margem, previsao + margem]
+typedef struct {
+    float previsao_linear[NUM_HORIZONTES];  // Previsão por regressão linear em cada horizonte
+    float previsao_holt[NUM_HORIZONTES];    // Previsão por suavização Holt em cada horizonte
+    float margem_linear[NUM_HORIZONTES];    // Meia largura pelo erro padrão da regressão (estreita demais sem lib/Previsao/calibracao.h)
+    float margem_holt[NUM_HORIZONTES];      // Meia largura pela variância do erro de um passo
+    float nivel_linear, inclinacao_linear;  // Reta no instante da leitura (°C e °C/s)
+    float nivel_holt, inclinacao_holt;      // Nível e tendência do Holt (°C e °C/s)
+} ResultadosPrevisao_t;
+
+typedef struct {
+    ParametrosPrevisao_t parametros;
+    float temp_filtrada;          // Saída do filtro exponencial
+    bool  filtro_iniciado;
+    float historico_temperatura[TAMANHO_HISTORICO_MAX]; // Histórico de temperaturas
+    float historico_tempo[TAMANHO_HISTORICO_MAX];       // Histórico de tempos
+    int   indice_historico;       // Índice atual no histórico
+    bool  historico_preenchido;   // Indica se o histórico está completo
+    // Somas da regressão sobre a janela, relativas a (base_tempo, base_temp) para não perder
+    // precisão; recalculadas com a base na leitura mais recente a cada janela completa
+    float base_tempo, base_temp;
+    float soma_x, soma_y, soma_xy, soma_x2, soma_y2;
+    int   insercoes_desde_base;
+    float nivel, tendencia;       // Estado da suavização Holt (tendência por período nominal)
+    bool  holt_iniciado;
+    float variancia_holt;         // Média exponencial do quadrado do erro de um passo
+    bool  variancia_iniciada;
+    float fatores_holt[NUM_HORIZONTES]; // Desvio em cada horizonte / desvio de um passo
+} Previsor_t;
+
+/* ---------- Funções ---------- */
+//Preenche os parâmetros com os valores usados pelo firmware
+void previsao_parametros_padrao(ParametrosPrevisao_t *parametros, float intervalo_leitura_s);
+//Zera o estado; a janela é limitada a TAMANHO_HISTORICO_MAX
+void previsao_iniciar(Previsor_t *previsor, const ParametrosPrevisao_t *parametros);
+//Aplica os parâmetros atuais a um estado restaurado (o salvo traz os da época); false se a janela mudou
+bool previsao_retomar(Previsor_t *previsor, const ParametrosPrevisao_t *parametros);
+//Soma 'deslocamento_s' a todos os instantes guardados (muda a origem do eixo de tempo)
+void previsao_deslocar_tempo(Previsor_t *previsor, float deslocamento_s);
+//Regressão linear simples de y em x; retorna false se não houver inclinação definida
+bool calcular_regressao(const float *x, const float *y, int n, float *m, float *b);
+//Razão entre o desvio do erro h passos à frente e o de um passo, para cada horizonte (Holt aditivo)
+void previsao_fatores_holt(const ParametrosPrevisao_t *parametros, float fatores[NUM_HORIZONTES]);
+//Avança a suavização Holt com uma leitura filtrada tomada 'passos' períodos nominais após a anterior
+//(1 com amostragem exata) e avalia nível + tendência e a margem em cada horizonte
+void previsao_atualizar_holt(Previsor_t *previsor, float temp, float passos, float previsoes[NUM_HORIZONTES],
+                             float margens[NUM_HORIZONTES]);
+//Segundos até nivel + inclinacao * t alcançar o limite: 0 se já alcançou, ETA_NUNCA se a
+//tendência é nula, se afasta do limite ou levaria mais que ETA_MAXIMO_S
+float previsao_tempo_ate_limite(float nivel, float inclinacao, float limite);
+//Filtra a leitura e, se válida, atualiza histórico, regressão e Holt e avalia todos os horizontes.
+//Retorna false para leituras fora da faixa
+bool previsao_processar(Previsor_t *previsor, float temp, float tempo_s, float *temp_filtrada, ResultadosPrevisao_t *resultados);
+
+#endif /* PREVISAO_H */
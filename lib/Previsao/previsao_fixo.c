@@ -0,0 +1,192 @@
+#include <math.h>
+#include <string.h>
+#include "previsao_fixo.h"
+
+#if PICO_ON_DEVICE
+#include "pico/divider.h"
+#define DIVIDIR64(a, b) div_s64s64((a), (b)) // Divisor de hardware do RP2040
+#else
+#define DIVIDIR64(a, b) ((a) / (b))
+#endif
+
+#define TEMP_BRUTA_MIN ((int16_t)(TEMPERATURA_VALIDA_MIN * 16)) // Faixa válida em 1/16 °C
+#define TEMP_BRUTA_MAX ((int16_t)(TEMPERATURA_VALIDA_MAX * 16))
+
+static q16_t q16_de_float(float valor) {
+    return (q16_t)(valor * Q16_UM + (valor >= 0 ? 0.5f : -0.5f));
+}
+
+//Produto com arredondamento; truncar acumularia viés na tendência do Holt
+static inline q16_t q16_mul(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b + (1 << 15)) >> 16);
+}
+
+static int janela_limitada(int tamanho_historico) {
+    if (tamanho_historico > TAMANHO_HISTORICO_MAX) return TAMANHO_HISTORICO_MAX;
+    return tamanho_historico < 2 ? 2 : tamanho_historico;
+}
+
+static void aplicar_parametros(PrevisorFixo_t *previsor, const ParametrosPrevisao_t *parametros) {
+    previsor->alpha_holt = q16_de_float(parametros->alpha_holt);
+    previsor->beta_holt = q16_de_float(parametros->beta_holt);
+    previsor->alfa_filtro = q16_de_float(parametros->alfa_filtro);
+    previsor->lambda_variancia = q16_de_float(parametros->lambda_variancia);
+    previsor->z_intervalo = parametros->z_intervalo;
+    previsao_fatores_holt(parametros, previsor->fatores_holt);
+    previsor->leituras_por_s = 1.0f / parametros->intervalo_leitura_s;
+    previsor->periodo = (int32_t)(parametros->intervalo_leitura_s * TEMPO_FIXO_POR_S + 0.5f);
+    if (previsor->periodo < 1) previsor->periodo = 1;
+    previsor->tamanho_historico = janela_limitada(parametros->tamanho_historico);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        previsor->horizontes[h] = (int32_t)(parametros->horizontes_s[h] * TEMPO_FIXO_POR_S);
+        previsor->passos_adiantados[h] = (int)(parametros->horizontes_s[h] / parametros->intervalo_leitura_s);
+    }
+}
+
+void previsao_fixo_iniciar(PrevisorFixo_t *previsor, const ParametrosPrevisao_t *parametros) {
+    memset(previsor, 0, sizeof(*previsor));
+    aplicar_parametros(previsor, parametros);
+}
+
+bool previsao_fixo_retomar(PrevisorFixo_t *previsor, const ParametrosPrevisao_t *parametros) {
+    if (janela_limitada(parametros->tamanho_historico) != previsor->tamanho_historico) return false;
+    aplicar_parametros(previsor, parametros);
+    return true;
+}
+
+void previsao_fixo_deslocar_tempo(PrevisorFixo_t *previsor, int32_t deslocamento_ms) {
+    // Os instantes da regressão só entram por diferença: basta mover a referência em ms
+    previsor->tempo_anterior_ms += (uint32_t)deslocamento_ms;
+}
+
+//Insere a leitura nas somas: desloca os x existentes para a nova referência, remove a mais
+//antiga se a janela estiver cheia e soma a nova em x = 0
+static void atualizar_somas(PrevisorFixo_t *previsor, uint32_t tempo, q16_t temp) {
+    int n = previsor->historico_preenchido ? previsor->tamanho_historico : previsor->indice_historico;
+    if (n > 0) {
+        int mais_recente = (previsor->indice_historico + previsor->tamanho_historico - 1) % previsor->tamanho_historico;
+        int64_t delta = (int32_t)(tempo - previsor->historico_tempo[mais_recente]);
+        // x' = x - delta
+        previsor->soma_x2 += n * delta * delta - 2 * delta * previsor->soma_x;
+        previsor->soma_xy -= delta * previsor->soma_y;
+        previsor->soma_x -= n * delta;
+    }
+    if (previsor->historico_preenchido) {
+        int64_t x = (int32_t)(previsor->historico_tempo[previsor->indice_historico] - tempo);
+        int64_t y = previsor->historico_temperatura[previsor->indice_historico];
+        previsor->soma_x -= x;
+        previsor->soma_y -= y;
+        previsor->soma_xy -= x * y;
+        previsor->soma_x2 -= x * x;
+        previsor->soma_y2 -= y * y;
+    }
+    previsor->soma_y += temp;
+    previsor->soma_y2 += (int64_t)temp * temp;
+}
+
+//Avalia a regressão das somas em cada horizonte a partir da leitura mais recente (x = 0)
+static void prever_linear_fixo(const PrevisorFixo_t *previsor, q16_t temp_atual, ResultadosPrevisao_t *resultados) {
+    float *previsoes = resultados->previsao_linear, *margens = resultados->margem_linear;
+    int n = previsor->historico_preenchido ? previsor->tamanho_historico : previsor->indice_historico;
+    int64_t soma_x = previsor->soma_x, soma_y = previsor->soma_y;
+    int64_t denominador = n * previsor->soma_x2 - soma_x * soma_x;
+    for (int h = 0; h < NUM_HORIZONTES; h++) margens[h] = 0;
+    resultados->inclinacao_linear = 0;
+    if (n < 2 || denominador <= 0) {
+        resultados->nivel_linear = Q16_PARA_FLOAT(n < 2 ? temp_atual : (q16_t)DIVIDIR64(soma_y, n));
+        for (int h = 0; h < NUM_HORIZONTES; h++) previsoes[h] = resultados->nivel_linear;
+        return;
+    }
+    int64_t numerador = n * previsor->soma_xy - soma_x * soma_y;
+    // previsão = média(y) + inclinação * (horizonte - média(x)), com inclinação = numerador / denominador.
+    // Quociente e resto separados mantêm o produto em 64 bits sem perder a fração da inclinação
+    int64_t quociente = DIVIDIR64(numerador, denominador);
+    int64_t resto = numerador - quociente * denominador;
+    // n * soma dos resíduos^2 = n * Syy - Sy^2 - numerador^2 / denominador (em Q16.16^2)
+    float residuos_n = (float)(n * previsor->soma_y2 - soma_y * soma_y) - (float)numerador * ((float)numerador / (float)denominador);
+    float variancia = n > 2 && residuos_n > 0 ? residuos_n / ((float)n * (n - 2)) : 0.0f;
+    // Reta em x = 0 (leitura mais recente); inclinação de Q16.16 por 1/16 s para °C/s
+    resultados->nivel_linear = Q16_PARA_FLOAT((q16_t)DIVIDIR64(soma_y - quociente * soma_x - DIVIDIR64(resto * soma_x, denominador), n));
+    resultados->inclinacao_linear = (float)numerador / (float)denominador * ((float)TEMPO_FIXO_POR_S / Q16_UM);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        int64_t dx = (int64_t)n * previsor->horizontes[h] - soma_x;
+        int64_t termo = quociente * dx + DIVIDIR64(resto * dx, denominador);
+        previsoes[h] = Q16_PARA_FLOAT((q16_t)DIVIDIR64(soma_y + termo, n));
+        // (x0 - média x)^2 / Sxx = dx^2 / (n * denominador)
+        float alavanca = (float)dx * ((float)dx / ((float)n * (float)denominador));
+        margens[h] = previsor->z_intervalo * sqrtf(variancia * (1.0f + 1.0f / n + alavanca)) * (1.0f / Q16_UM);
+    }
+}
+
+bool previsao_fixo_processar(PrevisorFixo_t *previsor, int16_t bruto, uint32_t tempo_ms,
+                             q16_t *temp_filtrada, ResultadosPrevisao_t *resultados) {
+    q16_t temp = Q16_DE_BRUTO(bruto);
+    // Filtro exponencial: f += alfa * (x - f)
+    if (!previsor->filtro_iniciado) {
+        previsor->temp_filtrada = temp;
+        previsor->filtro_iniciado = true;
+    } else {
+        previsor->temp_filtrada += q16_mul(previsor->alfa_filtro, temp - previsor->temp_filtrada);
+    }
+    *temp_filtrada = previsor->temp_filtrada;
+    if (!(bruto > TEMP_BRUTA_MIN && bruto < TEMP_BRUTA_MAX)) return false; // Validação da temperatura
+
+    // ms -> 1/16 s acumulando só diferenças (seguro na volta do contador) e o resto da divisão
+    uint32_t tempo = 0;
+    q16_t passos = Q16_UM; // Períodos nominais desde a leitura anterior, para o Holt
+    int n = previsor->historico_preenchido ? previsor->tamanho_historico : previsor->indice_historico;
+    if (n > 0) {
+        int mais_recente = (previsor->indice_historico + previsor->tamanho_historico - 1) % previsor->tamanho_historico;
+        uint32_t acumulado = previsor->resto_tempo + (tempo_ms - previsor->tempo_anterior_ms) * 2;
+        uint32_t decorrido = acumulado / 125;
+        tempo = previsor->historico_tempo[mais_recente] + decorrido;
+        previsor->resto_tempo = acumulado % 125;
+        // Só divide fora do período exato, o caso comum com a amostragem travada no período
+        if (decorrido > 0 && decorrido != (uint32_t)previsor->periodo) {
+            passos = (q16_t)DIVIDIR64((int64_t)decorrido << 16, previsor->periodo);
+        }
+    }
+    previsor->tempo_anterior_ms = tempo_ms;
+
+    // Atualiza somas e histórico para regressão
+    atualizar_somas(previsor, tempo, previsor->temp_filtrada);
+    previsor->historico_temperatura[previsor->indice_historico] = previsor->temp_filtrada;
+    previsor->historico_tempo[previsor->indice_historico] = tempo;
+    previsor->indice_historico = (previsor->indice_historico + 1) % previsor->tamanho_historico;
+    if (!previsor->historico_preenchido && previsor->indice_historico == 0) {
+        previsor->historico_preenchido = true;
+    }
+
+    // Suavização Holt com p períodos desde a leitura anterior (p = 1 no caso exato):
+    // n = n' + p t' + alfa (x - n' - p t'); t = t' + beta ((n - n') / p - t')
+    q16_t estimado = previsor->nivel + (passos == Q16_UM ? previsor->tendencia : q16_mul(previsor->tendencia, passos));
+    if (!previsor->holt_iniciado) {
+        previsor->nivel = estimado = previsor->temp_filtrada;
+        previsor->tendencia = 0;
+        previsor->holt_iniciado = true;
+    } else {
+        // Variância do erro de um passo: v += lambda * (e^2 - v), com e^2 exato em Q32.32
+        int64_t erro = previsor->temp_filtrada - estimado;
+        int64_t quadrado = erro * erro;
+        if (!previsor->variancia_iniciada) {
+            previsor->variancia_holt = quadrado;
+            previsor->variancia_iniciada = true;
+        } else {
+            previsor->variancia_holt += (previsor->lambda_variancia * (quadrado - previsor->variancia_holt)) >> 16;
+        }
+    }
+    q16_t nivel_anterior = previsor->nivel;
+    previsor->nivel = estimado + q16_mul(previsor->alpha_holt, previsor->temp_filtrada - estimado);
+    q16_t variacao = previsor->nivel - nivel_anterior;
+    if (passos != Q16_UM) variacao = (q16_t)DIVIDIR64((int64_t)variacao << 16, passos);
+    previsor->tendencia += q16_mul(previsor->beta_holt, variacao - previsor->tendencia);
+    float desvio = previsor->z_intervalo * sqrtf((float)previsor->variancia_holt) * (1.0f / Q16_UM);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        resultados->previsao_holt[h] = Q16_PARA_FLOAT(previsor->nivel + previsor->tendencia * previsor->passos_adiantados[h]);
+        resultados->margem_holt[h] = desvio * previsor->fatores_holt[h];
+    }
+    resultados->nivel_holt = Q16_PARA_FLOAT(previsor->nivel);
+    resultados->inclinacao_holt = Q16_PARA_FLOAT(previsor->tendencia) * previsor->leituras_por_s;
+    prever_linear_fixo(previsor, previsor->temp_filtrada, resultados);
+    return true;
+}
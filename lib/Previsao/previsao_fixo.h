@@ -0,0 +1,58 @@
+#ifndef PREVISAO_FIXO_H
+#define PREVISAO_FIXO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "previsao.h"
+
+/* ---------- Ponto fixo Q16.16 ---------- */
+typedef int32_t q16_t;
+
+#define Q16_UM               (1 << 16)
+#define Q16_DE_BRUTO(bruto)  ((q16_t)(bruto) << 12)          // 1/16 °C do DS18B20 -> Q16.16 °C
+#define Q16_PARA_FLOAT(q)    ((float)(q) * (1.0f / Q16_UM))  // Só na saída para o barramento
+#define TEMPO_FIXO_POR_S     16                              // Tempo da regressão em 1/16 s
+
+/* Domínio sem estouro das somas de 64 bits da regressão: janela de até
+ * TAMANHO_HISTORICO_MAX leituras cobrindo até 600 s e horizonte de até 3600 s.
+ * As somas são exatas e atualizadas em O(1); só as margens dos intervalos
+ * saem em float, como as previsões */
+
+/* ---------- Estado ---------- */
+typedef struct {
+    q16_t alpha_holt, beta_holt, alfa_filtro;  // Parâmetros convertidos uma vez na iniciação
+    int   tamanho_historico;
+    int32_t horizontes[NUM_HORIZONTES];         // Horizontes em 1/16 s
+    int   passos_adiantados[NUM_HORIZONTES];    // Horizontes em leituras (Holt)
+    int32_t periodo;                            // Período nominal entre leituras em 1/16 s
+    float leituras_por_s;                       // Converte a tendência do Holt para °C/s
+    q16_t temp_filtrada;
+    bool  filtro_iniciado;
+    q16_t historico_temperatura[TAMANHO_HISTORICO_MAX]; // Histórico filtrado (Q16.16 °C)
+    uint32_t historico_tempo[TAMANHO_HISTORICO_MAX];    // Instantes das leituras (1/16 s)
+    int   indice_historico;
+    bool  historico_preenchido;
+    uint32_t tempo_anterior_ms;                 // Última leitura, para converter ms em 1/16 s sem deriva
+    uint32_t resto_tempo;                       // Resto da conversão (ms * 2 mod 125)
+    // Somas exatas da regressão com x relativo à leitura mais recente
+    int64_t soma_x, soma_y, soma_xy, soma_x2, soma_y2;
+    q16_t nivel, tendencia;                     // Estado da suavização Holt (tendência por período nominal)
+    bool  holt_iniciado;
+    q16_t lambda_variancia;
+    int64_t variancia_holt;                     // Média exponencial do erro de um passo ao quadrado (Q32.32 °C²)
+    bool  variancia_iniciada;
+    float z_intervalo;
+    float fatores_holt[NUM_HORIZONTES];         // Ver previsao_fatores_holt
+} PrevisorFixo_t;
+
+/* ---------- Funções ---------- */
+//Converte os parâmetros em float para Q16.16 e zera o estado
+void previsao_fixo_iniciar(PrevisorFixo_t *previsor, const ParametrosPrevisao_t *parametros);
+//Equivalentes a previsao_retomar e previsao_deslocar_tempo (deslocamento no eixo em ms de previsao_fixo_processar)
+bool previsao_fixo_retomar(PrevisorFixo_t *previsor, const ParametrosPrevisao_t *parametros);
+void previsao_fixo_deslocar_tempo(PrevisorFixo_t *previsor, int32_t deslocamento_ms);
+//Equivalente a previsao_processar sobre a leitura bruta do DS18B20 (1/16 °C) e o instante em ms
+bool previsao_fixo_processar(PrevisorFixo_t *previsor, int16_t bruto, uint32_t tempo_ms,
+                             q16_t *temp_filtrada, ResultadosPrevisao_t *resultados);
+
+#endif /* PREVISAO_FIXO_H */
@@ -0,0 +1,172 @@
+#include <math.h>
+#include <string.h>
+#include "previsao_multicanal.h"
+
+// No Pico, o laço por canal roda da SRAM: sem esperas do XIP a cada falta na cache da flash
+#ifdef LIB_PICO_PLATFORM
+#include "pico/platform.h"
+#define NA_SRAM(funcao) __not_in_flash_func(funcao)
+#else
+#define NA_SRAM(funcao) funcao
+#endif
+
+void previsao_multicanal_iniciar(PrevisorMulticanal_t *previsor, const ParametrosPrevisao_t *parametros, int canais) {
+    memset(previsor, 0, sizeof(*previsor));
+    previsor->parametros = *parametros;
+    if (previsor->parametros.tamanho_historico > TAMANHO_HISTORICO_MAX) previsor->parametros.tamanho_historico = TAMANHO_HISTORICO_MAX;
+    if (previsor->parametros.tamanho_historico < 2) previsor->parametros.tamanho_historico = 2;
+    previsor->canais = canais < 0 ? 0 : canais > PREVISAO_CANAIS_MAX ? PREVISAO_CANAIS_MAX : canais;
+    previsao_fatores_holt(&previsor->parametros, previsor->fatores_holt);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        previsor->passos_adiantados[h] = (int)(parametros->horizontes_s[h] / parametros->intervalo_leitura_s);
+    }
+}
+
+//Recalcula as somas com a base na leitura mais recente (ver reancorar_somas em previsao.c)
+static void reancorar_somas(PrevisorMulticanal_t *previsor, int n, int mais_recente) {
+    previsor->base_tempo = previsor->historico_tempo[mais_recente];
+    previsor->soma_x = previsor->soma_x2 = 0;
+    for (int i = 0; i < n; i++) {
+        float x = previsor->historico_tempo[i] - previsor->base_tempo;
+        previsor->soma_x += x;
+        previsor->soma_x2 += x * x;
+    }
+    for (int c = 0; c < previsor->canais; c++) {
+        const float *anel = previsor->historico[c];
+        float base = anel[mais_recente], soma_y = 0, soma_xy = 0, soma_y2 = 0;
+        for (int i = 0; i < n; i++) {
+            float x = previsor->historico_tempo[i] - previsor->base_tempo;
+            float y = anel[i] - base;
+            soma_y += y;
+            soma_xy += x * y;
+            soma_y2 += y * y;
+        }
+        previsor->base_temp[c] = base;
+        previsor->soma_y[c] = soma_y;
+        previsor->soma_xy[c] = soma_xy;
+        previsor->soma_y2[c] = soma_y2;
+    }
+    previsor->insercoes_desde_base = 0;
+}
+
+void NA_SRAM(previsao_multicanal_atualizar)(PrevisorMulticanal_t *previsor, const float *leituras, float tempo_s) {
+    const ParametrosPrevisao_t *p = &previsor->parametros;
+    const float alfa = p->alfa_filtro, alpha = p->alpha_holt, beta = p->beta_holt, lambda = p->lambda_variancia;
+    const bool primeira = previsor->atualizacoes == 0, segunda = previsor->atualizacoes == 1;
+    if (previsor->atualizacoes < 2) previsor->atualizacoes++;
+
+    // Parte comum: períodos nominais desde a chamada anterior (Holt), sai o instante mais antigo, entra o novo
+    int indice = previsor->indice_historico;
+    float passos = 1.0f;
+    if (!primeira) {
+        float decorrido = tempo_s - previsor->tempo_atual;
+        if (decorrido > 0) passos = decorrido / p->intervalo_leitura_s;
+    }
+    const bool remover = previsor->historico_preenchido;
+    const bool nova_base = !remover && indice == 0;
+    if (nova_base) previsor->base_tempo = tempo_s;
+    float x_antigo = remover ? previsor->historico_tempo[indice] - previsor->base_tempo : 0.0f;
+    float x = tempo_s - previsor->base_tempo;
+    if (remover) {
+        previsor->soma_x -= x_antigo;
+        previsor->soma_x2 -= x_antigo * x_antigo;
+    }
+    previsor->soma_x += x;
+    previsor->soma_x2 += x * x;
+    previsor->historico_tempo[indice] = tempo_s;
+    previsor->tempo_atual = tempo_s;
+
+    // Um passo de filtro, janela e Holt por canal
+    for (int c = 0; c < previsor->canais; c++) {
+        float leitura = leituras[c];
+        bool valida = leitura > TEMPERATURA_VALIDA_MIN && leitura < TEMPERATURA_VALIDA_MAX;
+        float filtrada;
+        if (primeira) {
+            filtrada = fminf(fmaxf(leitura, TEMPERATURA_VALIDA_MIN), TEMPERATURA_VALIDA_MAX);
+        } else {
+            filtrada = valida ? previsor->filtrada[c] * (1 - alfa) + leitura * alfa : previsor->filtrada[c];
+        }
+        previsor->invalidas[c] += !valida;
+        previsor->filtrada[c] = filtrada;
+
+        float *anel = previsor->historico[c];
+        if (remover) {
+            float y_antigo = anel[indice] - previsor->base_temp[c];
+            previsor->soma_y[c] -= y_antigo;
+            previsor->soma_xy[c] -= x_antigo * y_antigo;
+            previsor->soma_y2[c] -= y_antigo * y_antigo;
+        } else if (nova_base) {
+            previsor->base_temp[c] = filtrada;
+        }
+        anel[indice] = filtrada;
+        float y = filtrada - previsor->base_temp[c];
+        previsor->soma_y[c] += y;
+        previsor->soma_xy[c] += x * y;
+        previsor->soma_y2[c] += y * y;
+
+        float nivel = previsor->niveis[c], tendencia = previsor->tendencias[c];
+        float estimado = nivel + tendencia * passos;
+        if (primeira) {
+            nivel = estimado = filtrada;
+            tendencia = 0;
+        } else {
+            float erro = filtrada - estimado;
+            previsor->variancias[c] = segunda ? erro * erro
+                                              : previsor->variancias[c] + lambda * (erro * erro - previsor->variancias[c]);
+        }
+        float nivel_anterior = nivel;
+        nivel = alpha * filtrada + (1 - alpha) * estimado;
+        previsor->niveis[c] = nivel;
+        previsor->tendencias[c] = beta * (nivel - nivel_anterior) / passos + (1 - beta) * tendencia;
+    }
+
+    previsor->indice_historico = (indice + 1) % p->tamanho_historico;
+    if (!previsor->historico_preenchido && previsor->indice_historico == 0) {
+        previsor->historico_preenchido = true;
+    }
+    if (++previsor->insercoes_desde_base >= p->tamanho_historico) {
+        reancorar_somas(previsor, previsor->historico_preenchido ? p->tamanho_historico : previsor->indice_historico, indice);
+    }
+}
+
+void previsao_multicanal_resultados(const PrevisorMulticanal_t *previsor, int canal, ResultadosPrevisao_t *resultados) {
+    const ParametrosPrevisao_t *p = &previsor->parametros;
+    float temp_atual = previsor->filtrada[canal];
+
+    // Holt
+    float nivel = previsor->niveis[canal], tendencia = previsor->tendencias[canal];
+    float desvio = sqrtf(previsor->variancias[canal]);
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        resultados->previsao_holt[h] = nivel + tendencia * previsor->passos_adiantados[h];
+        resultados->margem_holt[h] = p->z_intervalo * desvio * previsor->fatores_holt[h];
+    }
+    resultados->nivel_holt = nivel;
+    resultados->inclinacao_holt = tendencia / p->intervalo_leitura_s;
+
+    // Regressão (mesmas contas de prever_linear em previsao.c)
+    int n = previsor->historico_preenchido ? p->tamanho_historico : previsor->indice_historico;
+    float media_x = n ? previsor->soma_x / n : 0;
+    float media_y = n ? previsor->soma_y[canal] / n : 0;
+    float sxx = previsor->soma_x2 - previsor->soma_x * media_x;
+    if (n < 2 || n * sxx < 1e-6f) {
+        for (int h = 0; h < NUM_HORIZONTES; h++) {
+            resultados->previsao_linear[h] = temp_atual;
+            resultados->margem_linear[h] = 0;
+        }
+        resultados->nivel_linear = temp_atual;
+        resultados->inclinacao_linear = 0;
+        return;
+    }
+    float sxy = previsor->soma_xy[canal] - previsor->soma_x * media_y;
+    float syy = previsor->soma_y2[canal] - previsor->soma_y[canal] * media_y;
+    float inclinacao = sxy / sxx;
+    float variancia = n > 2 ? fmaxf(syy - inclinacao * sxy, 0.0f) / (n - 2) : 0.0f;
+    float base_temp = previsor->base_temp[canal];
+    resultados->nivel_linear = base_temp + media_y + inclinacao * (previsor->tempo_atual - previsor->base_tempo - media_x);
+    resultados->inclinacao_linear = inclinacao;
+    for (int h = 0; h < NUM_HORIZONTES; h++) {
+        float dx = previsor->tempo_atual + p->horizontes_s[h] - previsor->base_tempo - media_x;
+        resultados->previsao_linear[h] = base_temp + media_y + inclinacao * dx;
+        resultados->margem_linear[h] = p->z_intervalo * sqrtf(variancia * (1.0f + 1.0f / n + dx * dx / sxx));
+    }
+}
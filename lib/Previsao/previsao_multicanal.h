@@ -0,0 +1,56 @@
+#ifndef PREVISAO_MULTICANAL_H
+#define PREVISAO_MULTICANAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "previsao.h"
+
+// Canais reservados em PrevisorMulticanal_t; as ferramentas de host e o benchmark sobrescrevem
+#ifndef PREVISAO_CANAIS_MAX
+#define PREVISAO_CANAIS_MAX         8
+#endif
+
+/* Mesmo pipeline de previsao_processar (filtro exponencial, janela da regressão e Holt) para
+ * várias sondas lidas no mesmo instante. O estado fica em estrutura de vetores: cada grandeza
+ * é um vetor indexado pelo canal e o histórico é um anel contíguo por canal, então a
+ * atualização é um único laço sobre os canais que percorre memória sequencial. Os tempos do
+ * histórico e as somas em x são comuns a todos os canais.
+ *
+ * Leituras fora da faixa válida repetem a temperatura filtrada anterior do canal (o histórico
+ * de tempos é único, então todo canal recebe um ponto a cada chamada); na primeira chamada,
+ * a leitura é limitada à faixa */
+typedef struct {
+    ParametrosPrevisao_t parametros;
+    int   canais;
+    int   passos_adiantados[NUM_HORIZONTES]; // Horizontes em leituras (Holt)
+    float fatores_holt[NUM_HORIZONTES];      // Ver previsao_fatores_holt
+
+    // Comum a todos os canais
+    float historico_tempo[TAMANHO_HISTORICO_MAX];
+    int   indice_historico;
+    bool  historico_preenchido;
+    int   atualizacoes;           // Chamadas até 2 (inicia filtro/Holt e depois a variância)
+    float tempo_atual;            // Instante da última atualização
+    int   insercoes_desde_base;
+    float base_tempo;
+    float soma_x, soma_x2;
+
+    // Um vetor por grandeza
+    float filtrada[PREVISAO_CANAIS_MAX];
+    float niveis[PREVISAO_CANAIS_MAX], tendencias[PREVISAO_CANAIS_MAX];
+    float variancias[PREVISAO_CANAIS_MAX];   // Variância do erro de um passo do Holt
+    float base_temp[PREVISAO_CANAIS_MAX];
+    float soma_y[PREVISAO_CANAIS_MAX], soma_xy[PREVISAO_CANAIS_MAX], soma_y2[PREVISAO_CANAIS_MAX];
+    uint32_t invalidas[PREVISAO_CANAIS_MAX]; // Leituras fora da faixa substituídas
+    float historico[PREVISAO_CANAIS_MAX][TAMANHO_HISTORICO_MAX]; // Anel filtrado de cada canal
+} PrevisorMulticanal_t;
+
+/* ---------- Funções ---------- */
+//Zera o estado de 'canais' sondas (limitado a PREVISAO_CANAIS_MAX)
+void previsao_multicanal_iniciar(PrevisorMulticanal_t *previsor, const ParametrosPrevisao_t *parametros, int canais);
+//Avança todos os canais com uma leitura de cada ('leituras' tem previsor->canais posições) no instante tempo_s
+void previsao_multicanal_atualizar(PrevisorMulticanal_t *previsor, const float *leituras, float tempo_s);
+//Previsões e margens do canal no instante da última atualização, como em previsao_processar
+void previsao_multicanal_resultados(const PrevisorMulticanal_t *previsor, int canal, ResultadosPrevisao_t *resultados);
+
+#endif /* PREVISAO_MULTICANAL_H */
@@ -0,0 +1,40 @@
+#include <string.h>
+#include "relogio.h"
+
+void relogio_iniciar(Relogio_t *relogio) {
+    memset(relogio, 0, sizeof(*relogio));
+}
+
+// Correção da deriva sobre um intervalo do relógio local (negativo se o cristal adianta)
+static int64_t correcao_us(int64_t decorrido_us, int32_t deriva_ppb) {
+    return decorrido_us * deriva_ppb / 1000000000;
+}
+
+void relogio_sincronizar(Relogio_t *relogio, uint64_t monotonico_us, uint64_t utc_us) {
+    ContadoresRelogio_t *contadores = &relogio->contadores;
+    contadores->sincronizacoes++;
+    if (relogio->sincronizado) {
+        int64_t decorrido_us = (int64_t)(monotonico_us - relogio->base_monotonico_us);
+        int64_t erro_us = (int64_t)(utc_us - relogio_utc_us(relogio, monotonico_us));
+        contadores->ultimo_erro_us = (int32_t)(erro_us > INT32_MAX ? INT32_MAX : erro_us < -INT32_MAX ? -INT32_MAX : erro_us);
+        if (erro_us > RELOGIO_LIMITE_SALTO_US || erro_us < -RELOGIO_LIMITE_SALTO_US) {
+            contadores->saltos++; // Não diz nada sobre o cristal: só reposiciona a base
+        } else if (decorrido_us >= (int64_t)RELOGIO_INTERVALO_DERIVA_S * 1000000) {
+            int64_t residuo_ppb = erro_us * 1000000000 / decorrido_us;
+            int64_t deriva = relogio->deriva_ppb + residuo_ppb / RELOGIO_GANHO_DERIVA;
+            if (deriva > RELOGIO_DERIVA_MAX_PPB) deriva = RELOGIO_DERIVA_MAX_PPB;
+            if (deriva < -RELOGIO_DERIVA_MAX_PPB) deriva = -RELOGIO_DERIVA_MAX_PPB;
+            relogio->deriva_ppb = (int32_t)deriva;
+        }
+    }
+    relogio->base_monotonico_us = monotonico_us;
+    relogio->base_utc_us = utc_us;
+    relogio->sincronizado = true;
+}
+
+uint64_t relogio_utc_us(const Relogio_t *relogio, uint64_t monotonico_us) {
+    if (!relogio->sincronizado) return 0;
+    // Instantes anteriores à base (amostras de antes da sincronização) também valem
+    int64_t decorrido_us = (int64_t)(monotonico_us - relogio->base_monotonico_us);
+    return relogio->base_utc_us + (uint64_t)(decorrido_us + correcao_us(decorrido_us, relogio->deriva_ppb));
+}
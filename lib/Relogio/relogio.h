@@ -0,0 +1,41 @@
+#ifndef RELOGIO_H
+#define RELOGIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ---------- Parâmetros ---------- */
+#define RELOGIO_LIMITE_SALTO_US     500000  // Erro acima disto é um salto (outro servidor, relógio ajustado): não estima deriva
+#define RELOGIO_INTERVALO_DERIVA_S  60      // Intervalo mínimo entre sincronizações para estimar a deriva
+#define RELOGIO_GANHO_DERIVA        4       // A estimativa anda 1/N do erro de frequência medido (suaviza o ruído do SNTP)
+#define RELOGIO_DERIVA_MAX_PPB      500000  // Limite da correção (500 ppm; o cristal do RP2040 fica em dezenas)
+
+/* ---------- Tipos ---------- */
+typedef struct {
+    uint32_t sincronizacoes;    // Horas recebidas
+    uint32_t saltos;            // Sincronizações com erro acima de RELOGIO_LIMITE_SALTO_US
+    int32_t  ultimo_erro_us;    // Hora recebida menos a estimada na última sincronização
+} ContadoresRelogio_t;
+
+/* Converte o relógio monotônico (time_us_64) em UTC: na última sincronização os dois valores
+ * casam exatamente, e a partir dela o tempo decorrido é corrigido pela deriva estimada do
+ * cristal. Cada sincronização compara a hora recebida com a estimada; o erro dividido pelo
+ * intervalo é o erro de frequência que sobrou, somado aos poucos à deriva. Sem travas: o
+ * chamador serializa o acesso */
+typedef struct {
+    bool     sincronizado;
+    uint64_t base_monotonico_us; // Relógio monotônico na última sincronização
+    uint64_t base_utc_us;       // UTC nesse instante (us desde 1970)
+    int32_t  deriva_ppb;        // Quanto o UTC anda a mais por unidade do relógio local (partes por bilhão)
+    ContadoresRelogio_t contadores;
+} Relogio_t;
+
+/* ---------- Funções ---------- */
+//Relógio ainda sem hora
+void relogio_iniciar(Relogio_t *relogio);
+//Registra uma hora recebida: 'utc_us' valia no instante 'monotonico_us' do relógio local
+void relogio_sincronizar(Relogio_t *relogio, uint64_t monotonico_us, uint64_t utc_us);
+//UTC (us desde 1970) do instante 'monotonico_us'; 0 antes da primeira sincronização
+uint64_t relogio_utc_us(const Relogio_t *relogio, uint64_t monotonico_us);
+
+#endif /* RELOGIO_H */
@@ -0,0 +1,143 @@
+#include <math.h>
+#include <string.h>
+#include "tendencia.h"
+
+void tendencia_iniciar(GraficoTendencia_t *grafico) {
+    memset(grafico, 0, sizeof(*grafico));
+}
+
+// Múltiplo de 1 °C (100 centésimos) abaixo ou acima de v, também para negativos
+static int32_t grau_abaixo(int32_t v) {
+    return (v >= 0 ? v / 100 : -((-v + 99) / 100)) * 100;
+}
+
+static int32_t grau_acima(int32_t v) {
+    return -grau_abaixo(-v);
+}
+
+// Linha (0 = topo do gráfico) de um valor na escala atual, limitada ao gráfico
+static int linha_do_valor(const GraficoTendencia_t *grafico, int32_t valor) {
+    int32_t faixa = grafico->escala_maxima - grafico->escala_minima;
+    int32_t linha = (grafico->escala_maxima - valor) * (TENDENCIA_ALTURA - 1) / faixa;
+    if (linha < 0) return 0;
+    if (linha > TENDENCIA_ALTURA - 1) return TENDENCIA_ALTURA - 1;
+    return (int)linha;
+}
+
+// Rasteriza na coluna x o segmento vertical entre as linhas a e b (liga um ponto ao anterior)
+static void rasterizar_coluna(GraficoTendencia_t *grafico, int x, int a, int b) {
+    if (a > b) { int t = a; a = b; b = t; }
+    for (int pagina = 0; pagina < TENDENCIA_PAGINAS; pagina++) {
+        int topo = pagina * 8;
+        int de = a > topo ? a - topo : 0;
+        int ate = b < topo + 7 ? b - topo : 7;
+        grafico->colunas[pagina][x] = (de <= ate) ? (uint8_t)((0xFF << de) & (0xFF >> (7 - ate))) : 0;
+    }
+}
+
+static int16_t valor_em(const GraficoTendencia_t *grafico, int i) {
+    return grafico->valores[(grafico->inicio + i) % TENDENCIA_COLUNAS];
+}
+
+// Refaz todas as colunas a partir dos pontos (só quando a escala muda)
+static void reconstruir(GraficoTendencia_t *grafico) {
+    memset(grafico->colunas, 0, sizeof(grafico->colunas));
+    int x = TENDENCIA_COLUNAS - grafico->quantidade;
+    int anterior = -1;
+    for (int i = 0; i < grafico->quantidade; i++, x++) {
+        int linha = linha_do_valor(grafico, valor_em(grafico, i));
+        rasterizar_coluna(grafico, x, anterior < 0 ? linha : anterior, linha);
+        anterior = linha;
+    }
+    grafico->ultima_linha = (uint8_t)anterior;
+    grafico->reconstrucoes++;
+}
+
+// Escala em graus inteiros cobrindo os pontos (e o limite, se estiver perto); true se mudou
+static bool ajustar_escala(GraficoTendencia_t *grafico, int limite) {
+    if (!grafico->quantidade) return false;
+    int32_t minimo = INT16_MAX, maximo = INT16_MIN;
+    for (int i = 0; i < grafico->quantidade; i++) {
+        int16_t v = valor_em(grafico, i);
+        if (v < minimo) minimo = v;
+        if (v > maximo) maximo = v;
+    }
+    int32_t limite_c = limite * 100;
+    if (limite_c >= minimo - TENDENCIA_MARGEM_LIMITE && limite_c <= maximo + TENDENCIA_MARGEM_LIMITE) {
+        if (limite_c < minimo) minimo = limite_c;
+        if (limite_c > maximo) maximo = limite_c;
+    }
+    minimo = grau_abaixo(minimo);
+    maximo = grau_acima(maximo);
+    if (maximo - minimo < TENDENCIA_FAIXA_MINIMA) maximo = minimo + TENDENCIA_FAIXA_MINIMA;
+    if (minimo == grafico->escala_minima && maximo == grafico->escala_maxima) return false;
+    grafico->escala_minima = (int16_t)minimo;
+    grafico->escala_maxima = (int16_t)maximo;
+    reconstruir(grafico);
+    return true;
+}
+
+void tendencia_adicionar(GraficoTendencia_t *grafico, float temperatura, int limite) {
+    int16_t valor = (int16_t)lroundf(temperatura * 100.0f);
+    if (grafico->quantidade < TENDENCIA_COLUNAS) {
+        grafico->valores[(grafico->inicio + grafico->quantidade++) % TENDENCIA_COLUNAS] = valor;
+    } else {
+        grafico->valores[grafico->inicio] = valor;
+        grafico->inicio = (grafico->inicio + 1) % TENDENCIA_COLUNAS;
+    }
+    if (ajustar_escala(grafico, limite)) return;
+
+    // Mesma escala: rola uma coluna para a esquerda e rasteriza só o ponto novo
+    for (int pagina = 0; pagina < TENDENCIA_PAGINAS; pagina++) {
+        memmove(grafico->colunas[pagina], grafico->colunas[pagina] + 1, TENDENCIA_COLUNAS - 1);
+    }
+    int linha = linha_do_valor(grafico, valor);
+    rasterizar_coluna(grafico, TENDENCIA_COLUNAS - 1, grafico->quantidade > 1 ? grafico->ultima_linha : linha, linha);
+    grafico->ultima_linha = (uint8_t)linha;
+    grafico->rolagens++;
+}
+
+// Acende um pixel do gráfico direto no ram_buffer (linha relativa ao topo do gráfico)
+static inline void acender(uint8_t *paginas, int x, int linha) {
+    paginas[(linha >> 3) * TENDENCIA_LARGURA + x] |= (uint8_t)(1u << (linha & 7));
+}
+
+void tendencia_desenhar(GraficoTendencia_t *grafico, ssd1306_t *ssd, int limite, const ExtensaoTendencia_t *extensao) {
+    if (ssd->width != TENDENCIA_LARGURA) return;
+    // ram_buffer[0] é o prefixo de dados do I2C; cada página ocupa 'width' bytes
+    uint8_t *paginas = ssd->ram_buffer + 1 + TENDENCIA_PAGINA_INICIAL * TENDENCIA_LARGURA;
+    ajustar_escala(grafico, limite); // O limite pode ter mudado desde o último ponto
+    for (int pagina = 0; pagina < TENDENCIA_PAGINAS; pagina++) {
+        uint8_t *destino = paginas + pagina * TENDENCIA_LARGURA;
+        memcpy(destino, grafico->colunas[pagina], TENDENCIA_COLUNAS);
+        memset(destino + TENDENCIA_COLUNAS, 0, TENDENCIA_COLUNAS_PREVISAO);
+    }
+    if (!grafico->quantidade) return;
+
+    // Limite de urgência tracejado, só se estiver dentro da escala
+    int32_t limite_c = limite * 100;
+    if (limite_c >= grafico->escala_minima && limite_c <= grafico->escala_maxima) {
+        int linha = linha_do_valor(grafico, limite_c);
+        for (int x = 0; x < TENDENCIA_LARGURA; x += 4) {
+            acender(paginas, x, linha);
+            acender(paginas, x + 1, linha);
+        }
+    }
+    // Separador pontilhado entre o histórico e a previsão
+    for (int linha = 0; linha < TENDENCIA_ALTURA; linha += 2) acender(paginas, TENDENCIA_COLUNAS, linha);
+    if (!extensao) return;
+
+    float minimo = grafico->escala_minima / 100.0f, maximo = grafico->escala_maxima / 100.0f;
+    for (int k = 1; k < TENDENCIA_COLUNAS_PREVISAO; k++) {
+        float segundos = k * extensao->periodo_s;
+        float holt = extensao->nivel_holt + extensao->inclinacao_holt * segundos;
+        float linear = extensao->nivel_linear + extensao->inclinacao_linear * segundos;
+        // Fora da escala a previsão não é desenhada (em vez de ficar presa na borda)
+        if (holt >= minimo && holt <= maximo) {
+            acender(paginas, TENDENCIA_COLUNAS + k, linha_do_valor(grafico, lroundf(holt * 100.0f)));
+        }
+        if (!(k & 1) && linear >= minimo && linear <= maximo) {
+            acender(paginas, TENDENCIA_COLUNAS + k, linha_do_valor(grafico, lroundf(linear * 100.0f)));
+        }
+    }
+}
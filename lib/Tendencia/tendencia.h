@@ -0,0 +1,47 @@
+#ifndef TENDENCIA_H
+#define TENDENCIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+/* ---------- Geometria (display 128x64, páginas de 8 linhas) ---------- */
+#define TENDENCIA_LARGURA            128   // Colunas do display
+#define TENDENCIA_PAGINA_INICIAL     1     // A página 0 fica para o cabeçalho de texto
+#define TENDENCIA_PAGINAS            7     // Páginas do gráfico
+#define TENDENCIA_ALTURA             (TENDENCIA_PAGINAS * 8)
+#define TENDENCIA_COLUNAS_PREVISAO   16    // Colunas à direita para a extensão das previsões
+#define TENDENCIA_COLUNAS            (TENDENCIA_LARGURA - TENDENCIA_COLUNAS_PREVISAO) // Pontos do histórico
+#define TENDENCIA_FAIXA_MINIMA       200   // Menor faixa vertical (centésimos de °C)
+#define TENDENCIA_MARGEM_LIMITE      500   // Limite a até esta distância dos dados entra na escala (centésimos)
+
+/* ---------- Tipos ---------- */
+// Tendência atual de cada modelo, para estender o gráfico à direita
+typedef struct {
+    float nivel_linear, inclinacao_linear;  // °C e °C/s
+    float nivel_holt, inclinacao_holt;
+    float periodo_s;                        // Tempo representado por uma coluna
+} ExtensaoTendencia_t;
+
+/* Os pontos ficam em um anel e as colunas já rasterizadas ficam no formato das páginas do
+ * SSD1306 (um byte = 8 linhas). Um ponto novo rola as colunas uma posição e rasteriza só a
+ * última; tudo é refeito apenas quando a escala (graus inteiros) muda */
+typedef struct {
+    int16_t valores[TENDENCIA_COLUNAS];     // Pontos em centésimos de °C (circular)
+    int     inicio, quantidade;
+    int16_t escala_minima, escala_maxima;   // Faixa vertical atual (múltiplos de 1 °C)
+    uint8_t ultima_linha;                   // Linha do ponto mais recente (liga a próxima coluna)
+    uint8_t colunas[TENDENCIA_PAGINAS][TENDENCIA_COLUNAS]; // Bytes prontos, alinhados à direita
+    uint32_t rolagens, reconstrucoes;       // Atualizações incrementais e completas
+} GraficoTendencia_t;
+
+/* ---------- Funções ---------- */
+//Esvazia o gráfico
+void tendencia_iniciar(GraficoTendencia_t *grafico);
+//Acrescenta um ponto à direita (°C); rola uma coluna ou refaz tudo se a escala mudar
+void tendencia_adicionar(GraficoTendencia_t *grafico, float temperatura, int limite);
+//Copia as colunas para as páginas 1..7 do ram_buffer e sobrepõe a linha do limite (tracejada) e,
+//se extensao não for NULL, a previsão Holt (contínua) e a linear (pontilhada) à direita
+void tendencia_desenhar(GraficoTendencia_t *grafico, ssd1306_t *ssd, int limite, const ExtensaoTendencia_t *extensao);
+
+#endif /* TENDENCIA_H */
@@ -12,7 +12,8 @@
 // This example uses a common include to avoid repetition
 #include "lwipopts_examples_common.h"
 
-#define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL+1)
+// One for the MQTT cyclic timer and one for SNTP
+#define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL+2)
 
 #ifdef MQTT_CERT_INC
 #define LWIP_ALTCP               1
@@ -27,7 +28,23 @@
 #define TCP_WND  16384
 #endif // MQTT_CERT_INC
 
-// This defaults to 4
-#define MQTT_REQ_MAX_IN_FLIGHT 5
+// This defaults to 4; main.c leaves 6 for the subscriptions and a history page, the rest is the publish window
+#define MQTT_REQ_MAX_IN_FLIGHT 12
+
+// This defaults to 256; the JSON payloads (/previsoes, /historico_resumo) and a full
+// periodic burst of topics must fit before TCP drains it
+#define MQTT_OUTPUT_RINGBUF_SIZE 1024
+
+// SNTP (pico_lwip_sntp): the server is a name or an IP (SNTP_SERVIDOR in main.c). Each reply goes
+// to main.c's UTC clock; requests carry that clock's time so lwIP can remove the round trip
+#define SNTP_SERVER_DNS          1
+#define SNTP_UPDATE_DELAY        (15 * 60 * 1000)  // Defaults to 1 h; shorter gives the drift estimate more points
+#define SNTP_CHECK_RESPONSE      2                 // Reply must echo our transmit timestamp
+#define SNTP_COMP_ROUNDTRIP      1
+void relogio_sntp_ajustar(unsigned long segundos, unsigned long microssegundos);
+void relogio_sntp_hora(unsigned long *segundos, unsigned long *microssegundos);
+#define SNTP_SET_SYSTEM_TIME_US(sec, us)  relogio_sntp_ajustar((sec), (us))
+#define SNTP_GET_SYSTEM_TIME(sec, us)     do { unsigned long s_, us_; relogio_sntp_hora(&s_, &us_); \
+                                               (sec) = s_; (us) = us_; } while (0)
 
 #endif
@@ -3,4 +3,8 @@
 
 #include "mbedtls_config_examples_common.h"
 
+// Retomada de sessão por ticket (RFC 5077) além do ID de sessão: reconexões MQTT/TLS fazem
+// handshake abreviado, sem a troca de chaves ECDHE/RSA
+#define MBEDTLS_SSL_SESSION_TICKETS
+
 #endif
\ No newline at end of file
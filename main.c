@@ -11,16 +11,45 @@
 #include "hardware/adc.h"
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#if PERFIL_BAIXO_CONSUMO
+#include "hardware/timer.h"
+#include "hardware/structs/clocks.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/systick.h"
+#endif
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
+#include "timers.h"
 #include "lwip/apps/mqtt.h"
 #include "lwip/dns.h"
+#include "lwip/apps/sntp.h"
 #include "lwip/altcp_tls.h"
+#include "lwip/apps/mqtt_priv.h" // mqtt_client_t.conn (contexto TLS) e .output (anel de saída)
+#ifdef MQTT_CERT_INC
+#include "mbedtls/ssl.h"
+#include MQTT_CERT_INC           // TLS_ROOT_CERT: CA do broker em PEM
+#endif
 #include "ssd1306.h"
 #include "ds18b20.h"
 #include "matriz_led.h"
+#include "fila_spsc.h"
+#include "eventos.h"
+#include "alerta.h"
+#include "previsao.h"
+#include "previsao_fixo.h"
+#include "calibracao.h"
+#include "hampel.h"
+#include "historico.h"
+#include "tendencia.h"
+#include "log.h"
+#include "persistencia.h"
+#include "agendador.h"
+#include "relogio.h"
 
 /*============================================================================
  * CONFIGURAÇÃO DE REDE
@@ -31,6 +60,9 @@
 #define MQTT_SERVER     ""   // IP do broker ou hostname
 #define MQTT_USERNAME   ""         // Deixe "" se broker anônimo
 #define MQTT_PASSWORD   ""           // Deixe "" se broker anônimo
+#ifndef SNTP_SERVIDOR
+#define SNTP_SERVIDOR   "pool.ntp.org" // Servidor NTP (nome ou IP); o CMake troca por um daemon local nos testes
+#endif
 /*============================================================================
  * DEFINIÇÕES DE HARDWARE
  * Pinos usados no projeto.
@@ -49,25 +81,71 @@
  * PARÂMETROS DA LÓGICA DE APLICAÇÃO
  * Constantes que controlam o comportamento do sistema.
  *===========================================================================*/
-#define TAMANHO_HISTORICO_TEMP      30    // Tamanho do histórico de temperaturas
-#define INTERVALO_PREVISAO_SEGUNDOS 300   // Intervalo para previsão (segundos)
 #define INTERVALO_LEITURA_SEGUNDOS  5     // Intervalo de leitura da temperatura (segundos)
 
-#define DEBOUNCE_JOYSTICK_MS        300   // Tempo de debounce para joystick (ms)
+#define DEBOUNCE_JOYSTICK_MS        300   // Intervalo inicial de repetição do joystick (ms)
+#define REPETICAO_JOYSTICK_MIN_MS   60    // Intervalo mínimo de repetição com o joystick mantido (ms)
+#define ACELERACAO_JOYSTICK_MS      40    // Redução do intervalo a cada repetição (ms)
+#define REPETICOES_PASSO_LARGO      10    // Repetições até o passo de ajuste aumentar
+#define PASSO_LARGO_URGENCIA        5     // Passo de ajuste após REPETICOES_PASSO_LARGO (°C)
 #define DEBOUNCE_BOTAO_MS           50    // Tempo de debounce para botões (ms)
-#define TIMEOUT_ATUALIZACAO_DISPLAY_MS 100 // Timeout para atualização do display (ms)
+
+#define AMOSTRAS_JOYSTICK           32    // Amostras do ADC promediadas por bloco de DMA
+#define DIVISOR_CLOCK_ADC           47999.0f // 48 MHz / (1 + 47999) = 1 kHz de amostragem
+#define LIMIAR_JOYSTICK_ALTO        3000  // Média acima disto = joystick para cima
+#define LIMIAR_JOYSTICK_BAIXO       1000  // Média abaixo disto = joystick para baixo
+
+#define TELA_CONFIGURACAO           0     // Ajuste da temperatura de urgência
+#define TELA_RESULTADOS             1     // Leitura, previsões, ETA e situação
+#define TELA_TENDENCIA              2     // Gráfico do histórico com as previsões
+#define FONTES_TENDENCIA            (1 + NUM_NIVEIS_HISTORICO) // Leituras e cada camada do histórico
+
+#define NOTIFICACAO_BOTAO_A         (1u << 0) // Bits de notificação da tarefa de entrada
+#define NOTIFICACAO_BOTAO_B         (1u << 1)
+#define NOTIFICACAO_JOYSTICK        (1u << 2)
 #define PISCAR_INTERVALO_MS         500   // Intervalo de piscar dos indicadores (ms)
+#if PERFIL_BAIXO_CONSUMO
+#define TIMEOUT_ATUALIZACAO_DISPLAY_MS PISCAR_INTERVALO_MS // Redesenha só no ritmo do piscar (ms)
+#define INTERVALO_POLL_CYW43_MS     1000  // Período do laço da tarefa Wi-Fi (ms)
+#else
+#define TIMEOUT_ATUALIZACAO_DISPLAY_MS 100 // Timeout para atualização do display (ms)
+#define INTERVALO_POLL_CYW43_MS     10    // Período do laço da tarefa Wi-Fi (ms)
+#endif
 
-/* Constantes do método Holt para previsão */
-#define ALPHA_HOLT 0.3f   // Fator de suavização do nível
-#define BETA_HOLT  0.1f   // Fator de suavização da tendência
+#define NUCLEO_REDE                 0     // Núcleo do Wi-Fi, MQTT e cyw43 (perfil SMP)
+#define NUCLEO_TEMPO_REAL           1     // Núcleo de leitura, previsão, display e indicadores (perfil SMP)
+#define CAPACIDADE_FILA_PUBLICACAO  16    // Instantâneos de estado aguardando a tarefa MQTT (potência de 2)
+#define AMOSTRAS_POR_RELATORIO      12    // Leituras entre relatórios de métricas de tempo
+#define LIMITES_JITTER_US           { 100, 500, 1000, 2000, 5000, 10000, 50000 } // Faixas do histograma de jitter
+#define NUM_FAIXAS_JITTER           8     // As de LIMITES_JITTER_US e uma acima da última
+#define TAMANHO_FILA_DISPLAY        16    // Eventos pendentes para a tarefa do display
+#define TAMANHO_FILA_EVENTOS_MQTT   4     // Alarmes e leituras pendentes para a tarefa MQTT
+#define INTERVALO_DRENO_LOG_MS      100   // Período da tarefa que esvazia o anel de log no USB CDC
+#define INTERVALO_RETOMADA_S        60    // Período do ponto de retomada na flash (ajustes e previsores)
+#define TOLERANCIA_RETOMADA_C       1.0f  // Diferença máxima entre a última leitura salva e a primeira após o boot
+#if PREVISAO_PONTO_FIXO
+#define FORMATO_RETOMADA            0x0401 // Versão 4 de PontoRetomada_t, previsor em ponto fixo
+#else
+#define FORMATO_RETOMADA            0x0400 // Versão 4 de PontoRetomada_t, previsor em float
+#endif
 
 /*============================================================================
  * CONFIGURAÇÃO MQTT
  * Parâmetros para comunicação com o broker MQTT.
  *===========================================================================*/
 #define MQTT_TOPIC_BASE             "/Temperatura_MQTT_Pico" // Tópico base MQTT
+#ifdef MQTT_CERT_INC
+#define MQTT_PORTA                  LWIP_IANA_PORT_SECURE_MQTT // 8883: MQTT sobre TLS
+#else
+#define MQTT_PORTA                  MQTT_PORT // 1883: MQTT sem TLS
+#endif
 #define MQTT_KEEP_ALIVE_S           60    // Tempo de keep-alive (segundos)
+#define RECONEXAO_MIN_MS            1000  // Espera antes da primeira nova tentativa (Wi-Fi ou broker)
+#define RECONEXAO_MAX_MS            60000 // Teto do recuo exponencial entre tentativas
+#define TIMEOUT_WIFI_MS             30000 // Associação completa (varredura de todos os canais e DHCP)
+#define TIMEOUT_WIFI_RAPIDO_MS      3000  // Associação direta ao AP salvo antes de cair para a completa
+#define INTERVALO_ESPERA_WIFI_MS    10    // Consulta do estado da associação direta
+#define VERSAO_REDE_SALVA           1     // Muda quando RedeSalva_t muda (registros antigos são ignorados)
 #define TEMP_PUBLISH_INTERVAL_S     10    // Intervalo de publicação (segundos)
 #define MQTT_SUBSCRIBE_QOS          1     // QoS para subscrição
 #define MQTT_PUBLISH_QOS            1     // QoS para publicação
@@ -77,49 +155,35 @@
 #define MQTT_WILL_QOS               1     // QoS da última vontade
 #define MQTT_DEVICE_NAME            "pico" // Nome do dispositivo
 #define MQTT_TOPIC_LEN              100   // Tamanho máximo do tópico
+#define TAMANHO_JSON_PREVISOES      384   // Payload de /previsoes e de /historico_resumo
+#define TAMANHO_JSON_AMOSTRAS       256   // Payload de /amostras
+#define AMOSTRAS_POR_LOTE           8     // Últimas leituras em cada /amostras (40 s: cobre publicações perdidas)
+#define REGISTROS_POR_PAGINA_HISTORICO 32 // Registros por página de /historico/resposta (cabe no anel de saída do MQTT)
+#define BYTES_CABECALHO_HISTORICO   18    // Cabeçalho de cada página de /historico/resposta
+#define TIMEOUT_PAGINA_HISTORICO_MS 5000  // Espera pela confirmação de uma página antes de desistir
+#define TENTATIVAS_PAGINA_HISTORICO 5     // Publicações recusadas (anel de saída cheio) antes de desistir
+#define TAMANHO_FILA_PEDIDOS_HISTORICO 2  // Consultas de histórico aguardando a tarefa de resposta
+#define RESERVA_REQUISICOES_MQTT    6     // Requisições fora do agendador: 5 subscrições e 1 página de histórico
+#define JANELA_PUBLICACAO_MAX       (MQTT_REQ_MAX_IN_FLIGHT - RESERVA_REQUISICOES_MQTT) // Publicações sem PUBACK
+#define INTERVALO_DESPACHO_MS       50    // Nova tentativa de envio enquanto houver valores na fila
+#define VALIDADE_TELEMETRIA_MS      (2 * TEMP_PUBLISH_INTERVAL_S * 1000) // Telemetria mais velha é descartada
 
 /*============================================================================
  * ESTRUTURAS DE DADOS
  * Definições de tipos usados no sistema.
  *===========================================================================*/
-typedef struct {
-    float temperatura;      // Temperatura registrada
-    TickType_t marca_tempo; // Marca de tempo da leitura
-} DadosTemperatura_t;
-
-typedef struct {
-    float previsao_linear;  // Previsão por regressão linear
-    float previsao_holt;    // Previsão por suavização Holt
-} ResultadosPrevisao_t;
-
-typedef enum {
-    COMANDO_PROXIMA_TELA,       // Avança para a próxima tela
-    COMANDO_TELA_ANTERIOR,      // Retorna à tela anterior
-    COMANDO_AJUSTAR_URGENCIA_SUBIR,  // Aumenta temperatura de urgência
-    COMANDO_AJUSTAR_URGENCIA_DESCER  // Diminui temperatura de urgência
-} TipoComando_t;
-
-typedef struct {
-    TipoComando_t tipo;     // Tipo do comando
-    int valor;              // Valor associado ao comando
-} ComandoUsuario_t;
-
 typedef struct {
     int   temperatura_urgencia;      // Limite de temperatura crítica
     float temperatura_atual;         // Temperatura atual
-    float temperatura_prevista;      // Previsão por regressão linear
-    float temperatura_prevista_holt; // Previsão por suavização Holt
+    ResultadosPrevisao_t previsoes;  // Previsões linear e Holt em cada horizonte
+    float eta_linear_s, eta_holt_s;  // Segundos até a urgência por modelo (ETA_NUNCA se não chega)
+    ContadoresHampel_t rejeicoes;    // Leituras trocadas ou descartadas pelo filtro de discrepantes
     int   tela_atual;                // Tela exibida no display
+    NivelAlerta_t nivel_alerta;      // Nível da máquina de alerta
     bool  configuracao_concluida;    // Estado da configuração
+    uint64_t marca_us;               // Início da conversão da leitura atual (time_us_64), base das previsões
 } EstadoSistema_t;
 
-typedef struct {
-    float historico_temperatura[TAMANHO_HISTORICO_TEMP]; // Histórico de temperaturas
-    float historico_tempo[TAMANHO_HISTORICO_TEMP];       // Histórico de tempos
-    int   indice_historico;       // Índice atual no histórico
-    bool  historico_preenchido;   // Indica se o histórico está completo
-} PrevisaoTemperatura_t;
-
 typedef struct {
     mqtt_client_t *inst;          // Instância do cliente MQTT
     struct mqtt_connect_client_info_t info; // Informações de conexão
@@ -127,26 +191,156 @@ typedef struct {
     char topic[MQTT_TOPIC_LEN];   // Tópico atual
     char data[64];                // Dados recebidos
     bool conectado;               // Estado da conexão
+    bool conectando;              // Conexão iniciada, aguardando o CONNACK
+    bool encerrado;               // Desconexão pedida por /exit: não reconecta
+    uint32_t inicio_conexao_ms;   // Início da tentativa atual (mede TCP + TLS + CONNACK)
+    uint32_t espera_reconexao_ms; // Recuo atual entre tentativas
+    uint32_t proxima_tentativa_ms;
+    bool broker_resolvido;        // server_addr válido (DNS ou registro salvo)
+    volatile bool resolvendo;     // Consulta DNS em andamento
+    bool broker_salvo;            // server_addr veio da flash e ainda não foi confirmado por um CONNACK
+    volatile bool gravar_rede;    // CONNACK recebido: a tarefa Wi-Fi atualiza o registro da flash
+    bool wifi_rapido;             // Associação direta ao AP salvo
+    volatile bool cyw43_pronto;   // cyw43_arch_init concluído: o lock do lwIP já pode ser tomado
+    uint32_t marco_wifi_ms, marco_broker_ms, marco_conexao_ms, marco_publicacao_ms; // Desde o boot (0 = ainda não)
+#ifdef MQTT_CERT_INC
+    mbedtls_ssl_session sessao_tls; // Última sessão negociada (ID ou ticket), oferecida na reconexão
+    bool sessao_tls_valida;
+    uint32_t handshakes_completos, handshakes_retomados;
+#endif
 } EstadoMQTT_t;
 
+// Último acesso bem-sucedido, gravado na flash para a próxima conexão pular a varredura, o DHCP e o DNS
+typedef struct {
+    uint32_t versao;
+    uint32_t assinatura;          // CRC de WIFI_SSID e MQTT_SERVER: outra rede ou outro broker invalida o registro
+    uint8_t  bssid[6];            // AP associado
+    uint16_t canal;
+    uint32_t ip, mascara, gateway; // Concessão DHCP (IPv4)
+    uint32_t broker;              // Endereço resolvido de MQTT_SERVER
+} RedeSalva_t;
+
+typedef struct {
+    uint16_t id;                  // Devolvido em cada página para o cliente casar a resposta
+    NivelHistorico_t nivel;       // Camada consultada
+    uint32_t inicio_s, fim_s;     // Intervalo pedido [inicio_s, fim_s) em segundos desde o boot
+} PedidoHistorico_t;
+
+// Tópicos publicados pelo agendador, na ordem de registro (o índice é o id no agendador)
+typedef enum {
+    TOPICO_TEMPERATURA,
+    TOPICO_PREVISAO_LINEAR,
+    TOPICO_PREVISAO_HOLT,
+    TOPICO_PREVISOES,
+    TOPICO_AMOSTRAS,
+    TOPICO_TEMPO_ATE_URGENCIA,
+    TOPICO_AMOSTRAS_REJEITADAS,
+    TOPICO_HISTORICO_RESUMO,
+    TOPICO_ESTADO,
+    TOPICO_PONTO_REGULAGEM,
+    TOPICO_PUBLICACAO,
+    TOPICO_ONLINE,
+    NUM_TOPICOS_PUBLICADOS
+} TopicoPublicado_t;
+
+#if PREVISAO_PONTO_FIXO
+typedef PrevisorFixo_t PrevisorAtivo_t; // Previsor do perfil compilado
+#else
+typedef Previsor_t PrevisorAtivo_t;
+#endif
+
+// Estado para retomar depois de um reset (queda de tensão, watchdog): os ajustes valem sempre; filtro
+// e previsores só se a primeira leitura após o boot confirmar que a temperatura não mudou no intervalo
+typedef struct {
+    uint32_t formato;             // FORMATO_RETOMADA
+    int32_t  temperatura_urgencia;
+    bool     configuracao_concluida;
+    float    temperatura;         // Última leitura filtrada
+    FiltroHampel_t hampel;
+    PrevisorAtivo_t previsor;     // Eixo de tempo com a última leitura em 0, para não crescer a cada boot
+    CalibracaoLinear_t calibracao; // Fatores da margem e previsões pendentes, no mesmo eixo do previsor
+} PontoRetomada_t;
+
+_Static_assert(sizeof(PontoRetomada_t) <= PERSISTENCIA_TAMANHO_MAXIMO, "PontoRetomada_t não cabe em um registro");
+
+typedef struct {
+    uint32_t n;                   // Número de medições
+    uint32_t min_us, max_us;      // Extremos medidos (us)
+    uint64_t soma_us;             // Soma para a média (us)
+} MetricaTempo_t;
+
+// Desvio absoluto de cada período de amostragem em relação ao nominal, desde o boot
+typedef struct {
+    uint32_t faixas[NUM_FAIXAS_JITTER]; // Contagem abaixo de cada limite de LIMITES_JITTER_US; a última, acima
+    uint32_t pior_us;
+} HistogramaJitter_t;
+
+// Últimas leituras com a marca de tempo de cada uma, em ordem (a mais antiga em 'inicio')
+typedef struct {
+    uint64_t marca_us[AMOSTRAS_POR_LOTE];
+    float    temperatura[AMOSTRAS_POR_LOTE];
+    int      inicio, quantidade;
+} LoteAmostras_t;
+
 /*============================================================================
  * VARIÁVEIS GLOBAIS
  * Variáveis compartilhadas entre as tarefas.
  *===========================================================================*/
-static EstadoSistema_t       estado_sistema = { .temperatura_urgencia = 30 };
-static PrevisaoTemperatura_t previsao       = {0};
+static EstadoSistema_t       estado_sistema = { .temperatura_urgencia = 30 }; // Escrito só pela tarefa do display
 static ssd1306_t             display;
 
-static SemaphoreHandle_t mutex_estado;     // Mutex para proteger estado_sistema
+// Cópia publicada de estado_sistema, lida sem bloqueio (seqlock)
+static EstadoSistema_t   estado_publicado;
+static volatile uint32_t sequencia_estado;           // Ímpar enquanto a cópia está sendo escrita
+static volatile uint32_t leituras_estado;            // Leituras de estado concluídas
+static volatile uint32_t leituras_estado_repetidas;  // Tentativas descartadas por concorrência com o escritor
 static SemaphoreHandle_t mutex_display;    // Mutex para proteger o display
-static QueueHandle_t     q_temp;           // Fila para dados de temperatura
-static QueueHandle_t     q_prev;           // Fila para previsões
-static QueueHandle_t     q_cmd;            // Fila para comandos do usuário
+static QueueHandle_t     fila_display;        // Eventos de amostra, previsão e comando para o display
+static QueueHandle_t     fila_eventos_mqtt;   // Alarmes para publicação imediata e leituras para /amostras
+static int               id_assinante_display, id_assinante_mqtt; // Ids no barramento (contadores de descarte)
+
+// Instantâneos de estado do núcleo de tempo real para a tarefa MQTT (sem mutex entre núcleos)
+static FilaSPSC_t      fila_publicacao;
+static EstadoSistema_t armazenamento_fila_publicacao[CAPACIDADE_FILA_PUBLICACAO];
+
+// Agregados por minuto, hora e dia: escritos pela tarefa de temperatura, lidos pelo display e pela MQTT
+static Historico_t       historico;
+static SemaphoreHandle_t mutex_historico;
+static QueueHandle_t     fila_pedidos_historico; // Consultas recebidas por MQTT
+static TaskHandle_t      tarefa_historico;       // Notificada pela confirmação de cada página
+
+static PontoRetomada_t   retomada;            // Lido no boot; depois, cópia do último gravado
+static bool              retomada_valida;
+static SemaphoreHandle_t mutex_flash;         // Serializa as gravações na flash (cada uma pausa o outro núcleo)
+
+static MetricaTempo_t metrica_periodo_amostra; // Intervalo real entre leituras do sensor
+static HistogramaJitter_t jitter_amostragem;   // Desvio do período nominal
+static MetricaTempo_t metrica_quadro_display;  // Tempo para desenhar e enviar um quadro
+
+// Relógio monotônico -> UTC, ajustado pelas respostas SNTP no contexto do lwIP e lido sem bloqueio (seqlock)
+static Relogio_t         relogio;
+static volatile uint32_t sequencia_relogio;
+
+static TaskHandle_t tarefa_entrada;   // Acordada pelos botões e pelo joystick (notificações)
+
+static TimerHandle_t timer_debounce[2];          // Debounce dos botões A e B
+static volatile bool botao_pressionado[2];       // Estado estável de cada botão
+static uint16_t      amostras_adc[AMOSTRAS_JOYSTICK]; // Destino do DMA do ADC
+static int           canal_dma_adc;              // Canal de DMA do joystick
+static volatile int  zona_joystick;              // -1 = baixo, 0 = centro, +1 = cima
+
+#if PERFIL_BAIXO_CONSUMO
+static int      alarme_sono = -1;        // Alarme de hardware que encerra o sono sem tick
+static uint64_t tempo_dormindo_us;       // Tempo total com o processador em WFI
+static uint32_t despertares;             // Número de entradas em sono
+static uint32_t ocioso_anterior, total_anterior, dormindo_anterior; // Base do último relatório
+#endif
 
 static uint slice_buzzer;      // Slice PWM do buzzer
 static uint channel_buzzer;    // Canal PWM do buzzer
 
 static EstadoMQTT_t mqtt_state; // Estado da conexão MQTT
+static Agendador_t  agendador;  // Publicações pendentes e em voo; acessado só com o lock do lwIP
 
 /*============================================================================
  * FUNÇÕES AUXILIARES
@@ -160,63 +354,339 @@ static inline const char *topico_completo(const char *sufixo) {
     return buf;
 }
 
-// Lê o estado do sistema de forma segura usando mutex
+// Publica um novo instantâneo do estado (apenas a tarefa do display chama)
+static void publicar_estado(const EstadoSistema_t *origem) {
+    uint32_t sequencia = sequencia_estado;
+    taskENTER_CRITICAL(); // Evita que um leitor no mesmo núcleo preempte a escrita no meio
+    __atomic_store_n(&sequencia_estado, sequencia + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    estado_publicado = *origem;
+    __atomic_store_n(&sequencia_estado, sequencia + 2, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL();
+}
+
+// Lê o estado do sistema sem bloqueio, repetindo se o escritor estiver atualizando a cópia
 static void ler_estado(EstadoSistema_t *destino) {
-    if (xSemaphoreTake(mutex_estado, pdMS_TO_TICKS(5))) {
-        *destino = estado_sistema;
-        xSemaphoreGive(mutex_estado);
-    } else {
-        memset(destino, 0, sizeof(*destino));
+    while (1) {
+        uint32_t inicio = __atomic_load_n(&sequencia_estado, __ATOMIC_ACQUIRE);
+        if (!(inicio & 1)) {
+            *destino = estado_publicado;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&sequencia_estado, __ATOMIC_RELAXED) == inicio) break;
+        }
+        __atomic_fetch_add(&leituras_estado_repetidas, 1, __ATOMIC_RELAXED); // Leitores em várias tarefas e núcleos
     }
+    __atomic_fetch_add(&leituras_estado, 1, __ATOMIC_RELAXED);
+}
+
+// Milissegundos desde o boot: vale antes do escalonador e em qualquer contexto (relógio do log)
+static uint32_t agora_ms(void) {
+    return (uint32_t)(time_us_64() / 1000);
 }
 
-// Determina a situacao com base na temperatura atual, prevista e limite
-static const char *determinar_situacao(float temp_atual, float temp_prevista, int urgencia) {
-    float diferenca = urgencia - temp_prevista;
-    if (temp_atual > urgencia) return "Grave";
-    if (diferenca > 5.0f)      return "Normal";
-    if (diferenca >= 0.0f)     return "Atenção";
-    return "Alerta";
+// Hora recebida por SNTP (SNTP_SET_SYSTEM_TIME_US em lwipopts.h). O escritor pode estar numa
+// interrupção ou numa tarefa: com as interrupções mascaradas, nenhum leitor do núcleo o interrompe
+void relogio_sntp_ajustar(unsigned long segundos, unsigned long microssegundos) {
+    uint32_t interrupcoes = save_and_disable_interrupts();
+    bool primeira = !relogio.sincronizado;
+    uint32_t saltos = relogio.contadores.saltos;
+    uint32_t sequencia = sequencia_relogio;
+    __atomic_store_n(&sequencia_relogio, sequencia + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    relogio_sincronizar(&relogio, time_us_64(), (uint64_t)segundos * 1000000 + microssegundos);
+    __atomic_store_n(&sequencia_relogio, sequencia + 2, __ATOMIC_RELEASE);
+    ContadoresRelogio_t contadores = relogio.contadores;
+    restore_interrupts(interrupcoes);
+    if (primeira) {
+        LOG_INFO("Hora UTC recebida de %s", SNTP_SERVIDOR);
+    } else if (contadores.saltos != saltos) {
+        LOG_AVISO("Hora UTC corrigida em %ld us", (long)contadores.ultimo_erro_us);
+    }
+}
+
+// UTC (us desde 1970) de um instante de time_us_64; 0 antes da primeira hora SNTP. Leituras de antes
+// da sincronização também ganham hora, pelo relógio atual
+static uint64_t utc_de(uint64_t marca_us) {
+    Relogio_t copia;
+    while (1) {
+        uint32_t inicio = __atomic_load_n(&sequencia_relogio, __ATOMIC_ACQUIRE);
+        if (!(inicio & 1)) {
+            copia = relogio;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&sequencia_relogio, __ATOMIC_RELAXED) == inicio) break;
+        }
+    }
+    return relogio_utc_us(&copia, marca_us);
+}
+
+// Hora local para o SNTP descontar a ida e volta (SNTP_GET_SYSTEM_TIME); sem hora ainda, o relógio
+// monotônico serve, porque só as diferenças entram na conta
+void relogio_sntp_hora(unsigned long *segundos, unsigned long *microssegundos) {
+    uint64_t agora_us = time_us_64();
+    uint64_t utc_us = utc_de(agora_us);
+    if (!utc_us) utc_us = agora_us;
+    *segundos = (unsigned long)(utc_us / 1000000);
+    *microssegundos = (unsigned long)(utc_us % 1000000);
+}
+
+// Copia um intervalo do histórico (0 = atual) sob o mutex; false se ainda não existir
+static bool ler_historico(NivelHistorico_t nivel, int idade, Agregado_t *agregado, uint32_t *inicio_s) {
+    bool existe = false;
+    if (xSemaphoreTake(mutex_historico, portMAX_DELAY)) {
+        existe = historico_ler(&historico, nivel, idade, agregado, inicio_s);
+        xSemaphoreGive(mutex_historico);
+    }
+    return existe;
 }
 
+// Acumula uma medição de tempo na métrica. Seção crítica: o relatório copia e zera a métrica de
+// outra tarefa (no perfil SMP, o spinlock do kernel vale para os dois núcleos)
+static void metrica_registrar(MetricaTempo_t *metrica, uint32_t valor_us) {
+    taskENTER_CRITICAL();
+    if (metrica->n == 0 || valor_us < metrica->min_us) metrica->min_us = valor_us;
+    if (valor_us > metrica->max_us) metrica->max_us = valor_us;
+    metrica->soma_us += valor_us;
+    metrica->n++;
+    taskEXIT_CRITICAL();
+}
+
+static void jitter_registrar(HistogramaJitter_t *histograma, uint32_t periodo_us, uint32_t nominal_us) {
+    static const uint32_t limites[NUM_FAIXAS_JITTER - 1] = LIMITES_JITTER_US;
+    uint32_t desvio_us = periodo_us > nominal_us ? periodo_us - nominal_us : nominal_us - periodo_us;
+    int faixa = 0;
+    while (faixa < NUM_FAIXAS_JITTER - 1 && desvio_us >= limites[faixa]) faixa++;
+    histograma->faixas[faixa]++;
+    if (desvio_us > histograma->pior_us) histograma->pior_us = desvio_us;
+}
+
+#if PERFIL_BAIXO_CONSUMO
 /*============================================================================
- * PREVISÃO DE TEMPERATURA
- * Funções para calcular previsões usando regressão linear e suavização Holt.
+ * BAIXO CONSUMO (TICKLESS IDLE)
+ * Substitui o SysTick por um alarme do timer de hardware enquanto ocioso.
  *===========================================================================*/
 
-// Calcula regressão linear simples para previsão
-static bool calcular_regressao(float *x, float *y, int n, float *m, float *b) {
-    if (n < 2) {
-        *m = 0;
-        *b = (n ? y[0] : 0);
-        return false;
+// Base de tempo das estatísticas de execução do FreeRTOS (us)
+uint32_t contador_tempo_execucao(void) {
+    return time_us_32();
+}
+
+// O alarme só precisa existir para tirar o processador do WFI
+static void callback_alarme_sono(uint alarme) {
+    (void)alarme;
+}
+
+static void iniciar_baixo_consumo(void) {
+    alarme_sono = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(alarme_sono, callback_alarme_sono);
+    // Periféricos sem uso recebem clock apenas com o processador acordado
+    clocks_hw->sleep_en0 = clocks_hw->wake_en0 & ~(CLOCKS_SLEEP_EN0_CLK_SYS_SPI1_BITS | CLOCKS_SLEEP_EN0_CLK_PERI_SPI1_BITS |
+                                                   CLOCKS_SLEEP_EN0_CLK_SYS_SPI0_BITS | CLOCKS_SLEEP_EN0_CLK_PERI_SPI0_BITS |
+                                                   CLOCKS_SLEEP_EN0_CLK_SYS_RTC_BITS | CLOCKS_SLEEP_EN0_CLK_RTC_RTC_BITS |
+                                                   CLOCKS_SLEEP_EN0_CLK_SYS_JTAG_BITS);
+    clocks_hw->sleep_en1 = clocks_hw->wake_en1 & ~(CLOCKS_SLEEP_EN1_CLK_SYS_UART1_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART1_BITS |
+                                                   CLOCKS_SLEEP_EN1_CLK_SYS_UART0_BITS | CLOCKS_SLEEP_EN1_CLK_PERI_UART0_BITS);
+}
+
+// Chamada pelo kernel com as interrupções habilitadas quando nenhuma tarefa está pronta
+void vPortSuppressTicksAndSleep(TickType_t ticks_esperados) {
+    __asm volatile ("cpsid i" ::: "memory");
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        __asm volatile ("cpsie i" ::: "memory");
+        return;
     }
-    float soma_x = 0, soma_y = 0, soma_xy = 0, soma_x2 = 0;
-    for (int i = 0; i < n; i++) {
-        soma_x += x[i];
-        soma_y += y[i];
-        soma_xy += x[i] * y[i];
-        soma_x2 += x[i] * x[i];
-    }
-    float denominador = n * soma_x2 - soma_x * soma_x;
-    if (fabsf(denominador) < 1e-6) {
-        *m = 0;
-        *b = soma_y / n;
-        return false;
+    systick_hw->csr &= ~M0PLUS_SYST_CSR_ENABLE_BITS; // Para o tick
+    uint32_t ciclos_tick = systick_hw->rvr + 1;
+    uint32_t ciclos_antes = ciclos_tick - systick_hw->cvr; // Parte do período corrida antes de parar
+    uint64_t inicio = time_us_64();
+    absolute_time_t alvo = from_us_since_boot(inicio + (uint64_t)ticks_esperados * portTICK_PERIOD_MS * 1000);
+    if (!hardware_alarm_set_target(alarme_sono, alvo)) {
+        // Interrupções pendentes acordam o WFI mesmo com PRIMASK ativo
+        scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+        __wfi();
+        scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+        hardware_alarm_cancel(alarme_sono);
     }
-    *m = (n * soma_xy - soma_x * soma_y) / denominador;
-    *b = (soma_y - *m * soma_x) / n;
-    return true;
+    uint64_t dormido = time_us_64() - inicio;
+    // Ticks inteiros desde o último tick; a fração que sobra encurta o próximo período, para a
+    // contagem do RTOS não atrasar em relação ao time_us_64 a cada sono
+    uint64_t ciclos = ciclos_antes + dormido * ciclos_tick / (portTICK_PERIOD_MS * 1000);
+    TickType_t ticks_dormidos = (TickType_t)(ciclos / ciclos_tick);
+    uint32_t resto = (uint32_t)(ciclos % ciclos_tick);
+    if (ticks_dormidos > ticks_esperados) ticks_dormidos = ticks_esperados;
+    if (ciclos_tick - resto < 2 && ticks_dormidos < ticks_esperados) { // Período restante curto demais para o SysTick
+        ticks_dormidos++;
+        resto = 0;
+    }
+    vTaskStepTick(ticks_dormidos);
+    tempo_dormindo_us += dormido;
+    despertares++;
+    systick_hw->rvr = ciclos_tick - resto - 1; // Só o restante do período em curso
+    systick_hw->cvr = 0;
+    systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+    systick_hw->rvr = ciclos_tick - 1; // Vale a partir do próximo tick (a recarga só é lida ao zerar)
+    __asm volatile ("cpsie i" ::: "memory");
 }
 
-// Calcula previsão linear com base no histórico
-static float prever_linear(float tempo_atual) {
-    float inclinacao, intercepcao;
-    int n = previsao.historico_preenchido ? TAMANHO_HISTORICO_TEMP : previsao.indice_historico;
-    if (n >= 2 && calcular_regressao(previsao.historico_tempo, previsao.historico_temperatura, n, &inclinacao, &intercepcao)) {
-        return inclinacao * (tempo_atual + INTERVALO_PREVISAO_SEGUNDOS) + intercepcao;
+// Imprime a fração do tempo ocioso e dormindo desde o último relatório
+static void relatar_ciclo_trabalho(void) {
+    uint32_t ocioso = ulTaskGetIdleRunTimeCounter();
+    uint32_t total = contador_tempo_execucao();
+    uint32_t dormindo = (uint32_t)tempo_dormindo_us;
+    uint32_t periodo = total - total_anterior;
+    if (total_anterior && periodo) {
+        LOG_INFO("Ocioso: %lu%% | Dormindo: %lu%% | Despertares: %lu",
+                 (unsigned long)((uint64_t)(ocioso - ocioso_anterior) * 100 / periodo),
+                 (unsigned long)((uint64_t)(dormindo - dormindo_anterior) * 100 / periodo),
+                 (unsigned long)despertares);
+    }
+    ocioso_anterior = ocioso;
+    total_anterior = total;
+    dormindo_anterior = dormindo;
+    despertares = 0;
+}
+#endif
+
+// Imprime e zera as métricas de jitter de amostragem e de tempo de quadro
+static void relatar_metricas(void) {
+    taskENTER_CRITICAL(); // Cópia e reinício atômicos em relação a metrica_registrar
+    MetricaTempo_t amostra = metrica_periodo_amostra, quadro = metrica_quadro_display;
+    memset(&metrica_periodo_amostra, 0, sizeof(metrica_periodo_amostra));
+    memset(&metrica_quadro_display, 0, sizeof(metrica_quadro_display));
+    taskEXIT_CRITICAL();
+    if (amostra.n) {
+        LOG_INFO("Periodo amostra: min %lu / med %lu / max %lu us (jitter %lu us)",
+                 (unsigned long)amostra.min_us, (unsigned long)(amostra.soma_us / amostra.n),
+                 (unsigned long)amostra.max_us, (unsigned long)(amostra.max_us - amostra.min_us));
+    }
+    if (quadro.n) {
+        LOG_INFO("Quadro display: min %lu / med %lu / max %lu us (%lu quadros)",
+                 (unsigned long)quadro.min_us, (unsigned long)(quadro.soma_us / quadro.n),
+                 (unsigned long)quadro.max_us, (unsigned long)quadro.n);
+    }
+#if LOG_NIVEL >= LOG_NIVEL_INFO
+    // Contagens por faixa de LIMITES_JITTER_US (<100/<500/.../<50000/acima), sem os limites para caber na linha
+    char faixas[NUM_FAIXAS_JITTER * 11];
+    size_t usado = 0;
+    for (int faixa = 0; faixa < NUM_FAIXAS_JITTER && usado < sizeof(faixas); faixa++) {
+        usado += snprintf(faixas + usado, sizeof(faixas) - usado, faixa ? "/%lu" : "%lu",
+                          (unsigned long)jitter_amostragem.faixas[faixa]);
+    }
+    LOG_INFO("Jitter do periodo: %s (pior %lu us)", faixas, (unsigned long)jitter_amostragem.pior_us);
+#endif
+    LOG_INFO("Leituras de estado: %lu (%lu repetidas)",
+             (unsigned long)leituras_estado, (unsigned long)leituras_estado_repetidas);
+    LOG_INFO("Eventos descartados: display %lu, mqtt %lu",
+             (unsigned long)eventos_descartes(id_assinante_display), (unsigned long)eventos_descartes(id_assinante_mqtt));
+#if LOG_NIVEL >= LOG_NIVEL_INFO
+    ContadoresLog_t contadores_log = log_contadores();
+    LOG_INFO("Log: %lu mensagens, %lu descartadas, %lu cortadas", (unsigned long)contadores_log.escritas,
+             (unsigned long)contadores_log.descartadas, (unsigned long)contadores_log.cortadas);
+    ContadoresAgendador_t publicacao = agendador.contadores; // Cópia sem o lock do lwIP: só para o log
+    LOG_INFO("Publicação MQTT: %lu enfileiradas, %lu coalescidas, %lu descartadas, %lu confirmadas "
+             "(%lu falhas, %lu recusadas), janela %u, confirmação em %lu ms",
+             (unsigned long)publicacao.enfileiradas, (unsigned long)publicacao.coalescidas,
+             (unsigned long)publicacao.descartadas, (unsigned long)publicacao.confirmadas,
+             (unsigned long)publicacao.falhas, (unsigned long)publicacao.recusadas, (unsigned)agendador.janela,
+             (unsigned long)agendador.confirmacao_ms);
+    ContadoresRelogio_t sntp = relogio.contadores; // Cópia sem o seqlock: só para o log
+    LOG_INFO("Relógio UTC: %lu sincronizações (%lu saltos), deriva %ld ppb, erro %ld us",
+             (unsigned long)sntp.sincronizacoes, (unsigned long)sntp.saltos, (long)relogio.deriva_ppb,
+             (long)sntp.ultimo_erro_us);
+    ContadoresPersistencia_t flash = persistencia_contadores();
+    LOG_INFO("Flash: %lu registros gravados, %lu setores apagados", (unsigned long)flash.gravacoes,
+             (unsigned long)flash.apagamentos);
+#endif
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    LOG_INFO("Heap FreeRTOS: %lu livres (mínimo %lu) de %lu", (unsigned long)xPortGetFreeHeapSize(),
+             (unsigned long)xPortGetMinimumEverFreeHeapSize(), (unsigned long)configTOTAL_HEAP_SIZE);
+#endif
+#if PERFIL_BAIXO_CONSUMO
+    relatar_ciclo_trabalho();
+#endif
+}
+
+// Cria uma tarefa, fixando-a ao núcleo indicado quando o perfil SMP está ativo. No PERFIL_ESTATICO
+// a pilha e o TCB vêm do chamador (CRIAR_TAREFA); nos demais, do heap do FreeRTOS
+static void criar_tarefa(TaskFunction_t funcao, const char *nome, uint32_t pilha, UBaseType_t prioridade,
+                         UBaseType_t nucleo, TaskHandle_t *handle, StackType_t *memoria_pilha, StaticTask_t *tcb) {
+    (void)nucleo;
+#if PERFIL_ESTATICO && PERFIL_SMP
+    TaskHandle_t criada = xTaskCreateStaticAffinitySet(funcao, nome, pilha, NULL, prioridade, memoria_pilha, tcb, 1u << nucleo);
+#elif PERFIL_ESTATICO
+    TaskHandle_t criada = xTaskCreateStatic(funcao, nome, pilha, NULL, prioridade, memoria_pilha, tcb);
+#else
+    (void)memoria_pilha;
+    (void)tcb;
+    TaskHandle_t criada = NULL;
+#if PERFIL_SMP
+    xTaskCreateAffinitySet(funcao, nome, pilha, NULL, prioridade, 1u << nucleo, &criada);
+#else
+    xTaskCreate(funcao, nome, pilha, NULL, prioridade, &criada);
+#endif
+#endif
+    if (handle) *handle = criada;
+}
+
+/* Criação dos objetos do RTOS. No PERFIL_ESTATICO cada um recebe memória própria em .bss, em
+ * símbolos com o nome do objeto (o relatório de RAM os agrupa por prefixo); nos demais perfis
+ * a memória vem do heap4 */
+#if PERFIL_ESTATICO
+#define CRIAR_TAREFA(funcao, nome, pilha, prioridade, nucleo, handle) do {                          \
+        static StackType_t pilha_##funcao[pilha];                                                   \
+        static StaticTask_t tcb_##funcao;                                                           \
+        criar_tarefa(funcao, nome, pilha, prioridade, nucleo, handle, pilha_##funcao, &tcb_##funcao); \
+    } while (0)
+#define CRIAR_FILA(fila, tamanho, tipo) do {                                                        \
+        static uint8_t armazenamento_##fila[(tamanho) * sizeof(tipo)];                              \
+        static StaticQueue_t controle_##fila;                                                       \
+        fila = xQueueCreateStatic(tamanho, sizeof(tipo), armazenamento_##fila, &controle_##fila);   \
+    } while (0)
+#define CRIAR_MUTEX(mutex) do {                                                                     \
+        static StaticSemaphore_t controle_##mutex;                                                  \
+        mutex = xSemaphoreCreateMutexStatic(&controle_##mutex);                                     \
+    } while (0)
+#define CRIAR_TIMER(timer, simbolo, nome, periodo, recarga, id, callback) do {                      \
+        static StaticTimer_t controle_##simbolo;                                                    \
+        timer = xTimerCreateStatic(nome, periodo, recarga, id, callback, &controle_##simbolo);      \
+    } while (0)
+#else
+#define CRIAR_TAREFA(funcao, nome, pilha, prioridade, nucleo, handle) \
+        criar_tarefa(funcao, nome, pilha, prioridade, nucleo, handle, NULL, NULL)
+#define CRIAR_FILA(fila, tamanho, tipo) fila = xQueueCreate(tamanho, sizeof(tipo))
+#define CRIAR_MUTEX(mutex) mutex = xSemaphoreCreateMutex()
+#define CRIAR_TIMER(timer, simbolo, nome, periodo, recarga, id, callback) \
+        timer = xTimerCreate(nome, periodo, recarga, id, callback)
+#endif
+
+// Única tarefa que escreve no stdio: esvazia o anel de log e avisa quando houve descarte.
+// Com prioridade mínima, um terminal lento só atrasa o log, nunca a rede ou as leituras
+static void tarefa_drenar_log(void *param) {
+    (void)param;
+    MensagemLog_t mensagem;
+    uint32_t descartadas_anteriores = 0;
+    while (1) {
+        while (log_retirar(&mensagem)) {
+            printf("%lu.%03lu %s %s\n", (unsigned long)(mensagem.marca_ms / 1000), (unsigned long)(mensagem.marca_ms % 1000),
+                   log_rotulo(mensagem.nivel), mensagem.texto);
+        }
+        uint32_t descartadas = log_contadores().descartadas;
+        if (descartadas != descartadas_anteriores) {
+            printf("(%lu mensagens de log descartadas)\n", (unsigned long)(descartadas - descartadas_anteriores));
+            descartadas_anteriores = descartadas;
+        }
+        vTaskDelay(pdMS_TO_TICKS(INTERVALO_DRENO_LOG_MS));
+    }
+}
+
+// Assinante de log do barramento: registra comandos e mudanças de situação
+static void registrar_evento(const Evento_t *evento, void *contexto) {
+    (void)contexto;
+    if (evento->tipo == EVENTO_COMANDO) {
+        LOG_DEPURACAO("Comando: %d (%d)", evento->comando.tipo, evento->comando.valor);
+    } else if (evento->tipo == EVENTO_ALARME) {
+        LOG_INFO("Situação: %s (%.1f C, urgência %d C)", NOMES_ALERTA[evento->alarme.nivel],
+                 evento->alarme.temperatura, evento->alarme.urgencia);
     }
-    return estado_sistema.temperatura_atual;
 }
 
 /*============================================================================
@@ -241,10 +711,31 @@ static void emitir_beep(int duracao_ms, int repeticoes, int frequencia) {
  * INDICADORES VISUAIS
  * Controla LEDs, matriz de LEDs e buzzer com base na situacao.
  *===========================================================================*/
+
+// Ações dos indicadores em cada nível de alerta
+typedef struct {
+    bool led_verde;            // LED verde aceso
+    bool led_vermelho;         // LED vermelho aceso
+    bool vermelho_pisca;       // LED vermelho acompanha o piscar
+    bool pisca;                // Matriz e buzzer só na fase visível do piscar
+    const uint8_t *padrao;     // Padrão da matriz 5x5
+    uint32_t cor;              // Cor do padrão
+    int beep_duracao_ms;       // Duração do beep (0 = buzzer desligado)
+    int beep_repeticoes;       // Repetições adicionais do beep
+    int beep_frequencia;       // Frequência do beep (Hz)
+} AcaoIndicadores_t;
+
+static const AcaoIndicadores_t ACOES_INDICADORES[NUM_NIVEIS_ALERTA] = {
+    [NIVEL_NORMAL]  = { true,  false, false, false, PAD_OK,  COR_VERDE,      0, 0,    0 },
+    [NIVEL_ATENCAO] = { true,  true,  false, true,  PAD_EXC, COR_AMARELO,  150, 0, 1500 },
+    [NIVEL_ALERTA]  = { false, true,  false, true,  PAD_X,   COR_VERMELHO, 100, 1, 2000 },
+    [NIVEL_GRAVE]   = { false, true,  true,  true,  PAD_X,   COR_VERMELHO,  80, 2, 2500 },
+};
+
 static TickType_t ultimo_piscar = 0; // Última vez que os indicadores piscaram
 static bool visivel = true;          // Estado de visibilidade dos indicadores
 
-static void atualizar_indicadores(const char *situacao, bool configurado) {
+static void atualizar_indicadores(NivelAlerta_t nivel, bool configurado) {
     if (!configurado) { // Desativa tudo se não configurado
         gpio_put(PINO_LED_VERDE, 0);
         gpio_put(PINO_LED_VERMELHO, 0);
@@ -257,38 +748,18 @@ static void atualizar_indicadores(const char *situacao, bool configurado) {
         visivel = !visivel;
         ultimo_piscar = agora;
     }
-    if (!strcmp(situacao, "Normal")) {
-        gpio_put(PINO_LED_VERDE, 1);
-        gpio_put(PINO_LED_VERMELHO, 0);
-        matriz_draw_pattern(PAD_OK, COR_VERDE);
+    const AcaoIndicadores_t *acao = &ACOES_INDICADORES[nivel];
+    gpio_put(PINO_LED_VERDE, acao->led_verde);
+    gpio_put(PINO_LED_VERMELHO, acao->led_vermelho && (!acao->vermelho_pisca || visivel));
+    if (acao->pisca && !visivel) {
+        matriz_clear();
+        return;
+    }
+    matriz_draw_pattern(acao->padrao, acao->cor);
+    if (acao->beep_duracao_ms) {
+        emitir_beep(acao->beep_duracao_ms, acao->beep_repeticoes, acao->beep_frequencia);
+    } else {
         pwm_set_enabled(slice_buzzer, false);
-    } else if (!strcmp(situacao, "Atenção")) {
-        gpio_put(PINO_LED_VERDE, 1);
-        gpio_put(PINO_LED_VERMELHO, 1);
-        if (visivel) {
-            matriz_draw_pattern(PAD_EXC, COR_AMARELO);
-            emitir_beep(150, 0, 1500);
-        } else {
-            matriz_clear();
-        }
-    } else if (!strcmp(situacao, "Alerta")) {
-        gpio_put(PINO_LED_VERDE, 0);
-        gpio_put(PINO_LED_VERMELHO, 1);
-        if (visivel) {
-            matriz_draw_pattern(PAD_X, COR_VERMELHO);
-            emitir_beep(100, 1, 2000);
-        } else {
-            matriz_clear();
-        }
-    } else { // "Grave"
-        gpio_put(PINO_LED_VERDE, 0);
-        gpio_put(PINO_LED_VERMELHO, visivel);
-        if (visivel) {
-            matriz_draw_pattern(PAD_X, COR_VERMELHO);
-            emitir_beep(80, 2, 2500);
-        } else {
-            matriz_clear();
-        }
     }
 }
 
@@ -306,19 +777,120 @@ static void exibir_tela_configuracao(int urgencia) {
     ssd1306_draw_string(&display, texto, (128 - strlen(texto) * 6) / 2, 40, false);
 }
 
+// Tempo até a urgência em até 4 caracteres: "--" (nunca), "45s", "12m", "3h05"
+static void formatar_eta(float segundos, char *texto, size_t tamanho) {
+    int s = (int)segundos;
+    if (segundos < 0) snprintf(texto, tamanho, "--");
+    else if (s < 60) snprintf(texto, tamanho, "%ds", s);
+    else if (s < 3600) snprintf(texto, tamanho, "%dm", s / 60);
+    else snprintf(texto, tamanho, "%dh%02d", s / 3600, s % 3600 / 60);
+}
+
 // Exibe a tela com resultados e situacao atual
-static void exibir_tela_resultados(float temp_atual, float temp_prevista, float temp_prevista_holt, int urgencia, const char *situacao) {
-    char buffer[30];
+static void exibir_tela_resultados(float temp_atual, float temp_prevista, float temp_prevista_holt,
+                                   float eta_linear_s, float eta_holt_s, int urgencia, NivelAlerta_t nivel) {
+    char buffer[30], eta_linear[8], eta_holt[8];
     snprintf(buffer, sizeof(buffer), "Temp urg: %d C", urgencia);
     ssd1306_draw_string(&display, buffer, 0, 0, false);
     snprintf(buffer, sizeof(buffer), "Atual: %.1fC", temp_atual);
-    ssd1306_draw_string(&display, buffer, 0, 14, false);
+    ssd1306_draw_string(&display, buffer, 0, 11, false);
     snprintf(buffer, sizeof(buffer), "Prev lin: %.1fC", temp_prevista);
-    ssd1306_draw_string(&display, buffer, 0, 28, false);
+    ssd1306_draw_string(&display, buffer, 0, 22, false);
     snprintf(buffer, sizeof(buffer), "Prev Holt: %.1fC", temp_prevista_holt);
-    ssd1306_draw_string(&display, buffer, 0, 42, false);
-    snprintf(buffer, sizeof(buffer), "Situcao: %s", situacao);
-    ssd1306_draw_string(&display, buffer, 0, 56, false);
+    ssd1306_draw_string(&display, buffer, 0, 33, false);
+    formatar_eta(eta_linear_s, eta_linear, sizeof(eta_linear));
+    formatar_eta(eta_holt_s, eta_holt, sizeof(eta_holt));
+    snprintf(buffer, sizeof(buffer), "ETA L%s H%s", eta_linear, eta_holt);
+    ssd1306_draw_string(&display, buffer, 0, 44, false);
+    snprintf(buffer, sizeof(buffer), "Situcao: %s", ROTULOS_ALERTA_DISPLAY[nivel]);
+    ssd1306_draw_string(&display, buffer, 0, 55, false);
+}
+
+// Tempo representado por uma coluna do gráfico de tendência (fonte 0 = leituras, demais = camadas)
+static uint32_t periodo_fonte_tendencia(int fonte) {
+    return fonte ? historico_periodo_s((NivelHistorico_t)(fonte - 1)) : INTERVALO_LEITURA_SEGUNDOS;
+}
+
+// Refaz o gráfico com as médias dos intervalos fechados da camada; retorna o início do mais recente
+static uint32_t carregar_tendencia_camada(GraficoTendencia_t *grafico, NivelHistorico_t nivel, int urgencia) {
+    tendencia_iniciar(grafico);
+    uint32_t ultimo_inicio_s = UINT32_MAX, inicio_s;
+    Agregado_t agregado;
+    for (int idade = TENDENCIA_COLUNAS; idade >= 1; idade--) {
+        if (ler_historico(nivel, idade, &agregado, &inicio_s) && agregado.contagem) {
+            tendencia_adicionar(grafico, historico_media(&agregado), urgencia);
+            ultimo_inicio_s = inicio_s;
+        }
+    }
+    return ultimo_inicio_s;
+}
+
+// Exibe o gráfico de tendência: cabeçalho com fonte, escala e urgência, histórico e previsões à direita
+static void exibir_tela_tendencia(GraficoTendencia_t *grafico, int fonte, const EstadoSistema_t *estado) {
+    uint32_t periodo_s = periodo_fonte_tendencia(fonte);
+    const ExtensaoTendencia_t extensao = {
+        .nivel_linear = estado->previsoes.nivel_linear, .inclinacao_linear = estado->previsoes.inclinacao_linear,
+        .nivel_holt = estado->previsoes.nivel_holt, .inclinacao_holt = estado->previsoes.inclinacao_holt,
+        .periodo_s = (float)periodo_s };
+    tendencia_desenhar(grafico, &display, estado->temperatura_urgencia, &extensao);
+
+    static const char *const ROTULOS_CAMADA[NUM_NIVEIS_HISTORICO] = { "1m", "1h", "1d" };
+    char rotulo[6], buffer[20];
+    if (fonte) snprintf(rotulo, sizeof(rotulo), "%s", ROTULOS_CAMADA[fonte - 1]);
+    else snprintf(rotulo, sizeof(rotulo), "%lus", (unsigned long)periodo_s);
+    if (!grafico->quantidade) {
+        snprintf(buffer, sizeof(buffer), "%s U%d", rotulo, estado->temperatura_urgencia);
+        ssd1306_draw_string(&display, buffer, 0, 0, false);
+        ssd1306_draw_string(&display, "Sem dados", 28, 32, false);
+        return;
+    }
+    snprintf(buffer, sizeof(buffer), "%s %d-%dC U%d", rotulo, grafico->escala_minima / 100,
+             grafico->escala_maxima / 100, estado->temperatura_urgencia);
+    ssd1306_draw_string(&display, buffer, 0, 0, false);
+}
+
+/*============================================================================
+ * RETOMADA APÓS RESET
+ * Ajustes, filtro de discrepantes e previsores vão periodicamente para a
+ * flash, para as previsões valerem já na primeira leitura após um reset.
+ *===========================================================================*/
+
+// Lido antes do escalonador: os ajustes entram direto no estado inicial
+static void carregar_retomada(void) {
+    retomada_valida = persistencia_ler(AREA_RETOMADA, &retomada, sizeof(retomada)) && retomada.formato == FORMATO_RETOMADA;
+    if (!retomada_valida) {
+        memset(&retomada, 0, sizeof(retomada));
+        return;
+    }
+    estado_sistema.temperatura_urgencia = retomada.temperatura_urgencia;
+    estado_sistema.configuracao_concluida = retomada.configuracao_concluida;
+    estado_sistema.tela_atual = retomada.configuracao_concluida ? TELA_RESULTADOS : TELA_CONFIGURACAO;
+    LOG_INFO("Ajustes retomados: urgência %d C%s", estado_sistema.temperatura_urgencia,
+             retomada.configuracao_concluida ? "" : " (configuração pendente)");
+}
+
+static void gravar_retomada(const EstadoSistema_t *estado, float temperatura, uint32_t tempo_ms,
+                            const FiltroHampel_t *hampel, const PrevisorAtivo_t *previsor,
+                            const CalibracaoLinear_t *calibracao) {
+    retomada.formato = FORMATO_RETOMADA;
+    retomada.temperatura_urgencia = estado->temperatura_urgencia;
+    retomada.configuracao_concluida = estado->configuracao_concluida;
+    retomada.temperatura = temperatura;
+    retomada.hampel = *hampel;
+    retomada.previsor = *previsor;
+#if PREVISAO_PONTO_FIXO
+    previsao_fixo_deslocar_tempo(&retomada.previsor, -(int32_t)tempo_ms);
+#else
+    previsao_deslocar_tempo(&retomada.previsor, -(tempo_ms / 1000.0f)); // A mesma conta do tempo da leitura: zera exato
+#endif
+    retomada.calibracao = *calibracao;
+    calibracao_deslocar_tempo(&retomada.calibracao, -(tempo_ms / 1000.0f));
+    bool gravado = false;
+    if (xSemaphoreTake(mutex_flash, portMAX_DELAY)) {
+        gravado = persistencia_gravar(AREA_RETOMADA, &retomada, sizeof(retomada));
+        xSemaphoreGive(mutex_flash);
+    }
+    if (!gravado) LOG_AVISO("Falha ao gravar o ponto de retomada");
 }
 
 /*============================================================================
@@ -327,61 +899,132 @@ static void exibir_tela_resultados(float temp_atual, float temp_prevista, float
  *===========================================================================*/
 static void tarefa_leitura_temperatura(void *param) {
     (void)param;
-    float nivel = 0, tendencia = 0; // Variáveis para suavização Holt
-    bool primeira_leitura = true, holt_iniciado = false;
-    const int passos_adiantados = INTERVALO_PREVISAO_SEGUNDOS / INTERVALO_LEITURA_SEGUNDOS;
-    TickType_t inicio = xTaskGetTickCount();
+    ParametrosPrevisao_t parametros;
+    previsao_parametros_padrao(&parametros, INTERVALO_LEITURA_SEGUNDOS);
+    ParametrosHampel_t parametros_hampel;
+    hampel_parametros_padrao(&parametros_hampel);
+    static FiltroHampel_t filtro_hampel;
+    hampel_iniciar(&filtro_hampel, &parametros_hampel);
+#if PREVISAO_PONTO_FIXO
+    static PrevisorFixo_t previsor; // Estático: o histórico fica fora da pilha da tarefa
+    previsao_fixo_iniciar(&previsor, &parametros);
+#else
+    static Previsor_t previsor;
+    previsao_iniciar(&previsor, &parametros);
+#endif
+    // A margem da regressão sozinha cobre bem menos que o nominal: o fator vem da cobertura observada
+    static CalibracaoLinear_t calibracao;
+    calibracao_iniciar(&calibracao, &parametros);
+    // Retomada: a última leitura salva fica um período antes da primeira deste boot (tempo 0), e os
+    // parâmetros passam a ser os compilados agora, não os gravados com o estado
+    uint32_t ultima_retomada_ms = 0;
+    bool conferir_retomada = retomada_valida;
+    if (retomada_valida) {
+        filtro_hampel = retomada.hampel;
+        memset(&filtro_hampel.contadores, 0, sizeof(filtro_hampel.contadores)); // Contadores são por boot
+        previsor = retomada.previsor;
+#if PREVISAO_PONTO_FIXO
+        bool compativel = previsao_fixo_retomar(&previsor, &parametros);
+        previsao_fixo_deslocar_tempo(&previsor, -INTERVALO_LEITURA_SEGUNDOS * 1000);
+#else
+        bool compativel = previsao_retomar(&previsor, &parametros);
+        previsao_deslocar_tempo(&previsor, -(float)INTERVALO_LEITURA_SEGUNDOS);
+#endif
+        calibracao = retomada.calibracao;
+        calibracao_retomar(&calibracao, &parametros);
+        calibracao_deslocar_tempo(&calibracao, -(float)INTERVALO_LEITURA_SEGUNDOS);
+        if (!compativel) {
+            LOG_AVISO("Janela da regressão mudou: previsores recomeçam a frio");
+#if PREVISAO_PONTO_FIXO
+            previsao_fixo_iniciar(&previsor, &parametros);
+#else
+            previsao_iniciar(&previsor, &parametros);
+#endif
+            calibracao_iniciar(&calibracao, &parametros);
+        }
+    }
+    // Período travado no relógio do RTOS: cada conversão começa um período exato depois da anterior,
+    // sem somar a duração da leitura. O eixo de tempo dos previsores vem do timer de 1 us
+    TickType_t proximo_despertar = xTaskGetTickCount();
+    uint64_t inicio_us = time_us_64(), marca_anterior_us = 0;
+    int leituras_desde_relatorio = 0;
     while (1) {
-        float temp = ds18b20_get_temperature();
-        if (primeira_leitura) {
-            nivel = temp;
-            tendencia = 0;
-            primeira_leitura = false;
+        // A marca de tempo da leitura é o início da conversão; a espera libera o processador
+        ds18b20_start_conversion();
+        uint64_t marca_us = time_us_64();
+        if (marca_anterior_us) {
+            uint32_t periodo_us = (uint32_t)(marca_us - marca_anterior_us);
+            metrica_registrar(&metrica_periodo_amostra, periodo_us);
+            jitter_registrar(&jitter_amostragem, periodo_us, INTERVALO_LEITURA_SEGUNDOS * 1000000u);
+        }
+        marca_anterior_us = marca_us;
+        if (++leituras_desde_relatorio >= AMOSTRAS_POR_RELATORIO) {
+            relatar_metricas();
+            leituras_desde_relatorio = 0;
         }
-        // Filtro exponencial para atenuar ruído
-        static float temp_filtrada = 0;
-        static bool primeiro_filtro = true;
-        temp_filtrada = primeiro_filtro ? (primeiro_filtro = false, temp) : temp_filtrada * 0.8f + temp * 0.2f;
-
-        if (temp > -20 && temp < 80) { // Validação da temperatura
-            // Atualiza histórico para regressão
-            float tempo = (xTaskGetTickCount() - inicio) * portTICK_PERIOD_MS / 1000.0f;
-            previsao.historico_temperatura[previsao.indice_historico] = temp_filtrada;
-            previsao.historico_tempo[previsao.indice_historico] = tempo;
-            previsao.indice_historico = (previsao.indice_historico + 1) % TAMANHO_HISTORICO_TEMP;
-            if (!previsao.historico_preenchido && previsao.indice_historico == 0) {
-                previsao.historico_preenchido = true;
+        vTaskDelay(pdMS_TO_TICKS(DS18B20_TEMPO_CONVERSAO_MS));
+
+        // Discrepantes (falhas do 1-Wire, 85 °C do power-on) viram a mediana antes de chegar ao histórico.
+        // Filtro, histórico, regressão e Holt ficam em lib/Previsao (o mesmo código do simulador de host);
+        // o Holt corrige a tendência pelo intervalo real entre as marcas de tempo
+        int16_t leitura = ds18b20_read_raw(), bruto;
+        if (conferir_retomada && leitura != DS18B20_VALOR_RESET) {
+            // Longe da última leitura salva, o estado retomado é velho demais: recomeça a frio
+            conferir_retomada = false;
+            if (fabsf(leitura * 0.0625f - retomada.temperatura) > TOLERANCIA_RETOMADA_C) {
+                LOG_AVISO("Retomada descartada: %.2f C salvo, %.2f C agora", retomada.temperatura, leitura * 0.0625f);
+                hampel_iniciar(&filtro_hampel, &parametros_hampel);
+#if PREVISAO_PONTO_FIXO
+                previsao_fixo_iniciar(&previsor, &parametros);
+#else
+                previsao_iniciar(&previsor, &parametros);
+#endif
+                calibracao_iniciar(&calibracao, &parametros);
+            } else {
+                LOG_INFO("Filtro e previsores retomados da flash");
             }
+        }
+        bool valida = false;
+        float temp_filtrada;
+        ResultadosPrevisao_t resultados;
+        uint32_t tempo_ms = (uint32_t)((marca_us - inicio_us) / 1000);
+        if (hampel_filtrar(&filtro_hampel, leitura, &bruto) != HAMPEL_DESCARTADA) {
+#if PREVISAO_PONTO_FIXO
+            // Sem FPU: tudo em inteiros a partir da leitura bruta, só a saída vira float
+            q16_t filtrada_q16;
+            valida = previsao_fixo_processar(&previsor, bruto, tempo_ms, &filtrada_q16, &resultados);
+            temp_filtrada = Q16_PARA_FLOAT(filtrada_q16);
+#else
+            valida = previsao_processar(&previsor, bruto * 0.0625f, tempo_ms / 1000.0f, &temp_filtrada, &resultados);
+#endif
+            if (valida) calibracao_aplicar(&calibracao, &parametros, tempo_ms / 1000.0f, bruto * 0.0625f, &resultados);
+        }
+        if (valida) {
+            // Publica no barramento; o display (dono de estado_sistema) e demais assinantes recebem
+            Evento_t evento = { .tipo = EVENTO_AMOSTRA,
+                                .amostra = { .temperatura = temp_filtrada, .marca_tempo = xTaskGetTickCount(),
+                                             .marca_us = marca_us, .rejeicoes = filtro_hampel.contadores } };
+            eventos_publicar(&evento);
+            evento = (Evento_t){ .tipo = EVENTO_PREVISAO, .previsao = resultados };
+            eventos_publicar(&evento);
 
-            // Suavização Holt
-            if (!holt_iniciado) {
-                nivel = temp_filtrada;
-                tendencia = 0;
-                holt_iniciado = true;
+            // Agregados de longo prazo (O(1) por leitura)
+            if (xSemaphoreTake(mutex_historico, portMAX_DELAY)) {
+                historico_registrar(&historico, temp_filtrada, (uint32_t)((marca_us - inicio_us) / 1000000));
+                xSemaphoreGive(mutex_historico);
             }
-            float nivel_anterior = nivel;
-            nivel = ALPHA_HOLT * temp_filtrada + (1 - ALPHA_HOLT) * (nivel + tendencia);
-            tendencia = BETA_HOLT * (nivel - nivel_anterior) + (1 - BETA_HOLT) * tendencia;
-            float previsao_holt = nivel + tendencia * passos_adiantados;
-
-            // Previsão linear
-            float previsao_linear_resultado = prever_linear(tempo);
-
-            // Envia dados para filas
-            DadosTemperatura_t dados = { .temperatura = temp_filtrada, .marca_tempo = xTaskGetTickCount() };
-            xQueueSend(q_temp, &dados, 0);
-            ResultadosPrevisao_t resultados = { .previsao_linear = previsao_linear_resultado, .previsao_holt = previsao_holt };
-            xQueueSend(q_prev, &resultados, 0);
-
-            // Atualiza estado global
-            if (xSemaphoreTake(mutex_estado, portMAX_DELAY)) {
-                estado_sistema.temperatura_atual = temp_filtrada;
-                estado_sistema.temperatura_prevista = previsao_linear_resultado;
-                estado_sistema.temperatura_prevista_holt = previsao_holt;
-                xSemaphoreGive(mutex_estado);
+
+            // Ponto de retomada a cada INTERVALO_RETOMADA_S ou logo que um ajuste confirmado muda
+            EstadoSistema_t estado;
+            ler_estado(&estado);
+            bool ajuste_mudou = estado.configuracao_concluida &&
+                                (estado.temperatura_urgencia != retomada.temperatura_urgencia || !retomada.configuracao_concluida);
+            if (ajuste_mudou || tempo_ms - ultima_retomada_ms >= INTERVALO_RETOMADA_S * 1000) {
+                gravar_retomada(&estado, temp_filtrada, tempo_ms, &filtro_hampel, &previsor, &calibracao);
+                ultima_retomada_ms = tempo_ms;
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(INTERVALO_LEITURA_SEGUNDOS * 1000));
+        vTaskDelayUntil(&proximo_despertar, pdMS_TO_TICKS(INTERVALO_LEITURA_SEGUNDOS * 1000));
     }
 }
 
@@ -389,54 +1032,122 @@ static void tarefa_leitura_temperatura(void *param) {
  * TAREFA: ENTRADA DO USUÁRIO
  * Processa entradas do joystick e botões.
  *===========================================================================*/
+// Borda em um botão: cada repique reinicia o timer, que só expira com o nível estável
+static void callback_gpio_botoes(uint gpio, uint32_t eventos) {
+    (void)eventos;
+    BaseType_t acordar = pdFALSE;
+    xTimerResetFromISR(timer_debounce[gpio == PINO_BOTAO_A ? 0 : 1], &acordar);
+    portYIELD_FROM_ISR(acordar);
+}
+
+// Fim do debounce: registra o nível estável e notifica apenas pressionamentos
+static void callback_debounce_botao(TimerHandle_t timer) {
+    uint pino = (uint)(uintptr_t)pvTimerGetTimerID(timer);
+    int indice = (pino == PINO_BOTAO_A) ? 0 : 1;
+    bool pressionado = !gpio_get(pino);
+    if (pressionado && !botao_pressionado[indice] && tarefa_entrada) {
+        xTaskNotify(tarefa_entrada, indice ? NOTIFICACAO_BOTAO_B : NOTIFICACAO_BOTAO_A, eSetBits);
+    }
+    botao_pressionado[indice] = pressionado;
+}
+
+// Bloco de amostras do ADC pronto: calcula a média e avisa só quando o joystick muda de zona
+static void callback_dma_adc(void) {
+    if (!dma_channel_get_irq1_status(canal_dma_adc)) return;
+    dma_channel_acknowledge_irq1(canal_dma_adc);
+    uint32_t soma = 0;
+    for (int i = 0; i < AMOSTRAS_JOYSTICK; i++) soma += amostras_adc[i];
+    dma_channel_set_write_addr(canal_dma_adc, amostras_adc, true); // Rearma para o próximo bloco
+    uint32_t media = soma / AMOSTRAS_JOYSTICK;
+    int zona = (media > LIMIAR_JOYSTICK_ALTO) ? 1 : (media < LIMIAR_JOYSTICK_BAIXO) ? -1 : 0;
+    if (zona != zona_joystick) {
+        zona_joystick = zona;
+        if (tarefa_entrada) {
+            BaseType_t acordar = pdFALSE;
+            xTaskNotifyFromISR(tarefa_entrada, NOTIFICACAO_JOYSTICK, eSetBits, &acordar);
+            portYIELD_FROM_ISR(acordar);
+        }
+    }
+}
+
+// Configura botões por interrupção e o ADC em modo contínuo com FIFO e DMA
+static void inicializar_entradas(void) {
+    CRIAR_TIMER(timer_debounce[0], debounce_a, "Botao_A", pdMS_TO_TICKS(DEBOUNCE_BOTAO_MS), pdFALSE,
+                (void *)(uintptr_t)PINO_BOTAO_A, callback_debounce_botao);
+    CRIAR_TIMER(timer_debounce[1], debounce_b, "Botao_B", pdMS_TO_TICKS(DEBOUNCE_BOTAO_MS), pdFALSE,
+                (void *)(uintptr_t)PINO_BOTAO_B, callback_debounce_botao);
+    gpio_set_irq_enabled_with_callback(PINO_BOTAO_A, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, callback_gpio_botoes);
+    gpio_set_irq_enabled(PINO_BOTAO_B, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+
+    adc_fifo_setup(true, true, 1, false, false); // FIFO com DREQ a cada amostra
+    adc_set_clkdiv(DIVISOR_CLOCK_ADC);
+    canal_dma_adc = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(canal_dma_adc);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    dma_channel_configure(canal_dma_adc, &config, amostras_adc, &adc_hw->fifo, AMOSTRAS_JOYSTICK, false);
+    dma_channel_set_irq1_enabled(canal_dma_adc, true);
+    irq_add_shared_handler(DMA_IRQ_1, callback_dma_adc, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+    dma_channel_start(canal_dma_adc);
+    adc_run(true);
+}
+
+// Publica um comando do usuário no barramento
+static void enviar_comando(TipoComando_t tipo, int valor) {
+    Evento_t comando = { .tipo = EVENTO_COMANDO, .comando = { .tipo = tipo, .valor = valor } };
+    eventos_publicar(&comando);
+}
+
 static void tarefa_entrada_usuario(void *param) {
     (void)param;
-    uint16_t valor_adc;
-    bool botao_a_pressionado = false, botao_b_pressionado = false;
-    TickType_t ultimo_joystick = 0;
-    ComandoUsuario_t comando;
+    TickType_t espera = portMAX_DELAY;
+    int repeticoes = 0;
     while (1) {
-        valor_adc = adc_read();
-        TickType_t agora = xTaskGetTickCount();
+        uint32_t notificacoes = 0;
+        // Bloqueia até um botão, uma mudança de zona do joystick ou o próximo passo de repetição
+        bool expirou = xTaskNotifyWait(0, UINT32_MAX, &notificacoes, espera) != pdTRUE;
         EstadoSistema_t estado;
         ler_estado(&estado);
-        // Processa entrada do joystick na tela de configuração
-        if (estado.tela_atual == 0 && (agora - ultimo_joystick) > pdMS_TO_TICKS(DEBOUNCE_JOYSTICK_MS)) {
-            if (valor_adc > 3000) {
-                comando.tipo = COMANDO_AJUSTAR_URGENCIA_SUBIR;
-                comando.valor = 1;
-                xQueueSend(q_cmd, &comando, 0);
-                ultimo_joystick = agora;
-            } else if (valor_adc < 1000) {
-                comando.tipo = COMANDO_AJUSTAR_URGENCIA_DESCER;
-                comando.valor = -1;
-                xQueueSend(q_cmd, &comando, 0);
-                ultimo_joystick = agora;
-            }
-        }
+        int tela = estado.tela_atual;
         // Processa botão A (próxima tela)
-        if (!gpio_get(PINO_BOTAO_A) && !botao_a_pressionado) {
-            botao_a_pressionado = true;
-            if (estado.tela_atual == 0) {
-                comando.tipo = COMANDO_PROXIMA_TELA;
-                xQueueSend(q_cmd, &comando, 0);
-                emitir_beep(100, 0, 2000);
-            }
-        } else if (gpio_get(PINO_BOTAO_A)) {
-            botao_a_pressionado = false;
+        if ((notificacoes & NOTIFICACAO_BOTAO_A) && tela != TELA_TENDENCIA) {
+            enviar_comando(COMANDO_PROXIMA_TELA, 0);
+            emitir_beep(100, 0, 2000);
+            tela++;
         }
         // Processa botão B (tela anterior)
-        if (!gpio_get(PINO_BOTAO_B) && !botao_b_pressionado) {
-            botao_b_pressionado = true;
-            if (estado.tela_atual != 0) {
-                comando.tipo = COMANDO_TELA_ANTERIOR;
-                xQueueSend(q_cmd, &comando, 0);
-                emitir_beep(100, 0, 2000);
-            }
-        } else if (gpio_get(PINO_BOTAO_B)) {
-            botao_b_pressionado = false;
+        if ((notificacoes & NOTIFICACAO_BOTAO_B) && tela != TELA_CONFIGURACAO) {
+            enviar_comando(COMANDO_TELA_ANTERIOR, 0);
+            emitir_beep(100, 0, 2000);
+            tela--;
+        }
+#if PERFIL_BAIXO_CONSUMO
+        adc_run(tela != TELA_RESULTADOS); // O joystick só é usado na configuração e na tendência
+#endif
+        // Joystick na tendência: um passo por deflexão troca a fonte do gráfico
+        int zona = zona_joystick;
+        if (tela == TELA_TENDENCIA && (notificacoes & NOTIFICACAO_JOYSTICK) && zona != 0) {
+            enviar_comando(COMANDO_FONTE_TENDENCIA, zona);
+        }
+        // Joystick na tela de configuração: passo imediato e repetição acelerada enquanto mantido
+        if (tela != TELA_CONFIGURACAO || zona == 0) {
+            repeticoes = 0;
+            espera = portMAX_DELAY;
+            continue;
         }
-        vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_BOTAO_MS));
+        if (notificacoes & NOTIFICACAO_JOYSTICK) {
+            repeticoes = 0; // Nova deflexão
+        } else if (!expirou) {
+            continue; // Acordado por um botão: mantém o ritmo de repetição
+        }
+        int passo = (repeticoes >= REPETICOES_PASSO_LARGO) ? PASSO_LARGO_URGENCIA : 1;
+        enviar_comando(zona > 0 ? COMANDO_AJUSTAR_URGENCIA_SUBIR : COMANDO_AJUSTAR_URGENCIA_DESCER, zona * passo);
+        int intervalo = DEBOUNCE_JOYSTICK_MS - repeticoes * ACELERACAO_JOYSTICK_MS;
+        espera = pdMS_TO_TICKS(MAX(intervalo, REPETICAO_JOYSTICK_MIN_MS));
+        repeticoes++;
     }
 }
 
@@ -446,60 +1157,112 @@ static void tarefa_entrada_usuario(void *param) {
  *===========================================================================*/
 static void tarefa_atualizar_display(void *param) {
     (void)param;
-    DadosTemperatura_t dados_temp;
-    ResultadosPrevisao_t resultados_prev;
-    ComandoUsuario_t comando;
+    Evento_t evento;
+    MaquinaAlerta_t maquina_alerta;
+    alerta_iniciar(&maquina_alerta, xTaskGetTickCount() * portTICK_PERIOD_MS);
+    // Gráficos de tendência: o das leituras rola a cada amostra; o da camada escolhida a cada intervalo fechado
+    static GraficoTendencia_t tendencia_leituras, tendencia_camada;
+    tendencia_iniciar(&tendencia_leituras);
+    tendencia_iniciar(&tendencia_camada);
+    int fonte_tendencia = 0;
+    uint32_t inicio_ultimo_intervalo = UINT32_MAX;
     while (1) {
-        xTaskNotifyWait(0, ULONG_MAX, NULL, pdMS_TO_TICKS(TIMEOUT_ATUALIZACAO_DISPLAY_MS));
-        // Recebe temperatura atual
-        if (xQueueReceive(q_temp, &dados_temp, 0) == pdTRUE) {
-            if (xSemaphoreTake(mutex_estado, portMAX_DELAY)) {
-                estado_sistema.temperatura_atual = dados_temp.temperatura;
-                xSemaphoreGive(mutex_estado);
+        bool estado_alterado = false;
+        // Espera o primeiro evento (ou o timeout de redesenho) e esvazia os pendentes
+        TickType_t espera = pdMS_TO_TICKS(TIMEOUT_ATUALIZACAO_DISPLAY_MS);
+        while (xQueueReceive(fila_display, &evento, espera) == pdTRUE) {
+            espera = 0;
+            estado_alterado = true;
+            switch (evento.tipo) {
+                case EVENTO_AMOSTRA:
+                    estado_sistema.temperatura_atual = evento.amostra.temperatura;
+                    estado_sistema.rejeicoes = evento.amostra.rejeicoes;
+                    estado_sistema.marca_us = evento.amostra.marca_us;
+                    tendencia_adicionar(&tendencia_leituras, evento.amostra.temperatura, estado_sistema.temperatura_urgencia);
+                    if (fonte_tendencia) {
+                        Agregado_t agregado;
+                        uint32_t inicio_s;
+                        if (ler_historico((NivelHistorico_t)(fonte_tendencia - 1), 1, &agregado, &inicio_s) &&
+                            agregado.contagem && inicio_s != inicio_ultimo_intervalo) {
+                            tendencia_adicionar(&tendencia_camada, historico_media(&agregado), estado_sistema.temperatura_urgencia);
+                            inicio_ultimo_intervalo = inicio_s;
+                        }
+                    }
+                    break;
+                case EVENTO_PREVISAO:
+                    estado_sistema.previsoes = evento.previsao;
+                    break;
+                case EVENTO_COMANDO:
+                    switch (evento.comando.tipo) {
+                        case COMANDO_PROXIMA_TELA:
+                            if (estado_sistema.tela_atual < TELA_TENDENCIA) estado_sistema.tela_atual++;
+                            estado_sistema.configuracao_concluida = true;
+                            break;
+                        case COMANDO_TELA_ANTERIOR:
+                            if (estado_sistema.tela_atual > TELA_CONFIGURACAO) estado_sistema.tela_atual--;
+                            estado_sistema.configuracao_concluida = estado_sistema.tela_atual != TELA_CONFIGURACAO;
+                            break;
+                        case COMANDO_FONTE_TENDENCIA:
+                            fonte_tendencia = (fonte_tendencia + evento.comando.valor + FONTES_TENDENCIA) % FONTES_TENDENCIA;
+                            if (fonte_tendencia) {
+                                inicio_ultimo_intervalo = carregar_tendencia_camada(&tendencia_camada,
+                                                                                    (NivelHistorico_t)(fonte_tendencia - 1),
+                                                                                    estado_sistema.temperatura_urgencia);
+                            }
+                            break;
+                        case COMANDO_AJUSTAR_URGENCIA_SUBIR:
+                        case COMANDO_AJUSTAR_URGENCIA_DESCER:
+                            estado_sistema.temperatura_urgencia += evento.comando.valor;
+                            break;
+                    }
+                    break;
+                default:
+                    break;
             }
         }
-        // Recebe previsões
-        if (xQueueReceive(q_prev, &resultados_prev, 0) == pdTRUE) {
-            if (xSemaphoreTake(mutex_estado, portMAX_DELAY)) {
-                estado_sistema.temperatura_prevista = resultados_prev.previsao_linear;
-                estado_sistema.temperatura_prevista_holt = resultados_prev.previsao_holt;
-                xSemaphoreGive(mutex_estado);
-            }
-        }
-        // Processa comandos do usuário
-        if (xQueueReceive(q_cmd, &comando, 0) == pdTRUE) {
-            if (xSemaphoreTake(mutex_estado, portMAX_DELAY)) {
-                switch (comando.tipo) {
-                    case COMANDO_PROXIMA_TELA:
-                        estado_sistema.tela_atual = 1;
-                        estado_sistema.configuracao_concluida = true;
-                        break;
-                    case COMANDO_TELA_ANTERIOR:
-                        estado_sistema.tela_atual = 0;
-                        estado_sistema.configuracao_concluida = false;
-                        break;
-                    case COMANDO_AJUSTAR_URGENCIA_SUBIR:
-                    case COMANDO_AJUSTAR_URGENCIA_DESCER:
-                        estado_sistema.temperatura_urgencia += comando.valor;
-                        break;
-                }
-                xSemaphoreGive(mutex_estado);
-            }
+        // Tempo até a urgência pela tendência atual de cada modelo
+        estado_sistema.eta_linear_s = previsao_tempo_ate_limite(estado_sistema.previsoes.nivel_linear,
+                                                                estado_sistema.previsoes.inclinacao_linear,
+                                                                estado_sistema.temperatura_urgencia);
+        estado_sistema.eta_holt_s = previsao_tempo_ate_limite(estado_sistema.previsoes.nivel_holt,
+                                                              estado_sistema.previsoes.inclinacao_holt,
+                                                              estado_sistema.temperatura_urgencia);
+
+        // Avança a máquina de alerta; mudanças de nível viram eventos de alarme
+        NivelAlerta_t nivel_anterior = estado_sistema.nivel_alerta;
+        estado_sistema.nivel_alerta = alerta_atualizar(&maquina_alerta, estado_sistema.temperatura_atual,
+                                                       &estado_sistema.previsoes, estado_sistema.temperatura_urgencia,
+                                                       xTaskGetTickCount() * portTICK_PERIOD_MS);
+        if (estado_sistema.nivel_alerta != nivel_anterior) {
+            estado_alterado = true;
+            Evento_t alarme = { .tipo = EVENTO_ALARME,
+                                .alarme = { .nivel = estado_sistema.nivel_alerta, .temperatura = estado_sistema.temperatura_atual,
+                                            .urgencia = estado_sistema.temperatura_urgencia } };
+            eventos_publicar(&alarme);
         }
+
         // Atualiza display e indicadores
-        EstadoSistema_t estado;
-        ler_estado(&estado);
-        const char *situacao = determinar_situacao(estado.temperatura_atual, estado.temperatura_prevista, estado.temperatura_urgencia);
-        atualizar_indicadores(situacao, estado.configuracao_concluida);
-        if (xSemaphoreTake(mutex_display, portMAX_DELAY)) {
+        const EstadoSistema_t estado = estado_sistema;
+        if (estado_alterado) {
+            publicar_estado(&estado);
+            // Entrega o novo estado à tarefa MQTT (que pode estar no outro núcleo)
+            fila_spsc_enviar(&fila_publicacao, &estado);
+        }
+        atualizar_indicadores(estado.nivel_alerta, estado.configuracao_concluida);
+        if (display.ram_buffer && xSemaphoreTake(mutex_display, portMAX_DELAY)) {
+            uint64_t inicio_quadro = time_us_64();
             ssd1306_fill(&display, false);
-            if (estado.tela_atual == 0) {
+            if (estado.tela_atual == TELA_CONFIGURACAO) {
                 exibir_tela_configuracao(estado.temperatura_urgencia);
+            } else if (estado.tela_atual == TELA_TENDENCIA) {
+                exibir_tela_tendencia(fonte_tendencia ? &tendencia_camada : &tendencia_leituras, fonte_tendencia, &estado);
             } else {
-                exibir_tela_resultados(estado.temperatura_atual, estado.temperatura_prevista,
-                                       estado.temperatura_prevista_holt, estado.temperatura_urgencia, situacao);
+                exibir_tela_resultados(estado.temperatura_atual, estado.previsoes.previsao_linear[HORIZONTE_PADRAO],
+                                       estado.previsoes.previsao_holt[HORIZONTE_PADRAO], estado.eta_linear_s,
+                                       estado.eta_holt_s, estado.temperatura_urgencia, estado.nivel_alerta);
             }
             ssd1306_send_data(&display);
+            metrica_registrar(&metrica_quadro_display, (uint32_t)(time_us_64() - inicio_quadro));
             xSemaphoreGive(mutex_display);
         }
     }
@@ -507,48 +1270,387 @@ static void tarefa_atualizar_display(void *param) {
 
 /*============================================================================
  * TAREFA: PUBLICAÇÃO MQTT
- * Publica dados no broker MQTT periodicamente.
+ * Publica dados no broker MQTT periodicamente. Cada valor passa pelo
+ * agendador (lib/Agendador), que guarda só o mais recente de cada tópico,
+ * põe alarmes à frente da telemetria e só chama mqtt_publish quando há
+ * requisição livre na janela e espaço no anel de saída do cliente.
  *===========================================================================*/
 
-// Callback para erros de publicação
+static const struct {
+    const char *sufixo;
+    uint16_t capacidade;          // Maior payload do tópico
+    uint8_t  qos;
+    bool     retain;
+} TOPICOS_PUBLICADOS[NUM_TOPICOS_PUBLICADOS] = {
+    [TOPICO_TEMPERATURA]         = { "/temperatura", 16, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_PREVISAO_LINEAR]     = { "/temperatura_previsao_regressao_linear", 16, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_PREVISAO_HOLT]       = { "/temperatura_previsao_holt", 16, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_PREVISOES]           = { "/previsoes", TAMANHO_JSON_PREVISOES, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_AMOSTRAS]            = { "/amostras", TAMANHO_JSON_AMOSTRAS, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_TEMPO_ATE_URGENCIA]  = { "/tempo_ate_urgencia", 48, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_AMOSTRAS_REJEITADAS] = { "/amostras_rejeitadas", 96, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_HISTORICO_RESUMO]    = { "/historico_resumo", TAMANHO_JSON_PREVISOES, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_ESTADO]              = { "/estado", 16, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_PONTO_REGULAGEM]     = { "/ponto_de_regulagem", 16, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_PUBLICACAO]          = { "/publicacao", 192, MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN },
+    [TOPICO_ONLINE]              = { MQTT_WILL_TOPIC, 4, MQTT_WILL_QOS, true },
+};
+
+// O ciclo periódico enfileira uma rajada de publicações QoS 1 com JSON de até TAMANHO_JSON_PREVISOES:
+// com os padrões do lwIP (4 requisições, anel de saída de 256 B) mqtt_publish devolveria ERR_MEM e
+// as previsões nunca sairiam. Os limites ficam em lib/Wifi/lwipopts.h
+_Static_assert(JANELA_PUBLICACAO_MAX >= 4, "MQTT_REQ_MAX_IN_FLIGHT pequeno demais para a janela de publicação");
+_Static_assert(MQTT_OUTPUT_RINGBUF_SIZE >= 5 + 2 + MQTT_TOPIC_LEN + 2 + TAMANHO_JSON_PREVISOES,
+               "/previsoes não cabe no anel de saída do cliente MQTT");
+
+static void iniciar_agendador(void) {
+    agendador_iniciar(&agendador, JANELA_PUBLICACAO_MAX, sizeof(MQTT_TOPIC_BASE) - 1);
+    for (int topico = 0; topico < NUM_TOPICOS_PUBLICADOS; topico++) {
+        int id = agendador_registrar(&agendador, TOPICOS_PUBLICADOS[topico].sufixo, TOPICOS_PUBLICADOS[topico].capacidade,
+                                     TOPICOS_PUBLICADOS[topico].qos, TOPICOS_PUBLICADOS[topico].retain);
+        if (id != topico) LOG_ERRO("Tópico %s não coube no agendador", TOPICOS_PUBLICADOS[topico].sufixo);
+    }
+}
+
+// Entrega o valor ao agendador; a telemetria expira se não sair a tempo, alarmes e estado não
+static void enfileirar_publicacao(TopicoPublicado_t topico, const char *dados, size_t tamanho,
+                                  PrioridadePublicacao_t prioridade) {
+    uint32_t validade_ms = prioridade == PRIORIDADE_TELEMETRIA ? VALIDADE_TELEMETRIA_MS : 0;
+    cyw43_arch_lwip_begin();
+    agendador_enfileirar(&agendador, topico, dados, tamanho, prioridade, validade_ms, agora_ms());
+    cyw43_arch_lwip_end();
+}
+
+// Bytes livres no anel de saída do cliente (a conta de mqtt_ringbuf_len, que é estática no lwIP)
+static size_t espaco_saida_mqtt(void) {
+    const struct mqtt_ringbuf_t *anel = &mqtt_state.inst->output;
+    uint32_t ocupado = (uint32_t)(anel->put - anel->get);
+    if (ocupado > 0xFFFF) ocupado += MQTT_OUTPUT_RINGBUF_SIZE;
+    return MQTT_OUTPUT_RINGBUF_SIZE - ocupado;
+}
+
+// Confirmação de uma publicação do agendador (arg = id do tópico); a primeira fecha a medida do
+// tempo até ficar online
 static void callback_publicacao(void *arg, err_t erro) {
-    if (erro) printf("Erro de publicação MQTT: %d\n", erro);
+    int id = (int)(intptr_t)arg;
+    agendador_confirmado(&agendador, id, erro == ERR_OK, agora_ms());
+    if (erro) {
+        LOG_AVISO("Publicação em %s sem confirmação (%d): valor de volta à fila", TOPICOS_PUBLICADOS[id].sufixo, erro);
+    } else if (!mqtt_state.marco_publicacao_ms) {
+        mqtt_state.marco_publicacao_ms = agora_ms();
+        LOG_INFO("Online %lu ms após o boot: Wi-Fi em %lu ms (%s), broker em %lu ms (%s), CONNACK em %lu ms",
+                 (unsigned long)mqtt_state.marco_publicacao_ms, (unsigned long)mqtt_state.marco_wifi_ms,
+                 mqtt_state.wifi_rapido ? "AP salvo" : "varredura", (unsigned long)mqtt_state.marco_broker_ms,
+                 mqtt_state.broker_salvo ? "salvo" : "DNS", (unsigned long)mqtt_state.marco_conexao_ms);
+    }
+}
+
+// Monta {"utc_us":N,"horizontes_s":[...],"linear":[...],"linear_inf":[...],"linear_sup":[...],"holt":[...],...}
+// com todos os horizontes, contados a partir de utc_us (null sem hora SNTP); os limites são previsão -/+ margem
+static size_t formatar_previsoes(const ResultadosPrevisao_t *previsoes, uint64_t utc_us, char *json, size_t tamanho) {
+    static const int horizontes[NUM_HORIZONTES] = HORIZONTES_PREVISAO_S;
+    static const struct { const char *nome; int modelo; float sinal; } series[] = {
+        { "linear", 0, 0.0f }, { "linear_inf", 0, -1.0f }, { "linear_sup", 0, 1.0f },
+        { "holt",   1, 0.0f }, { "holt_inf",   1, -1.0f }, { "holt_sup",   1, 1.0f },
+    };
+    const float *valores[2] = { previsoes->previsao_linear, previsoes->previsao_holt };
+    const float *margens[2] = { previsoes->margem_linear, previsoes->margem_holt };
+    char marca[24] = "null";
+    if (utc_us) snprintf(marca, sizeof(marca), "%llu", (unsigned long long)utc_us);
+    size_t usado = snprintf(json, tamanho, "{\"utc_us\":%s,\"horizontes_s\":[", marca);
+    for (int h = 0; h < NUM_HORIZONTES && usado < tamanho; h++) {
+        usado += snprintf(json + usado, tamanho - usado, h ? ",%d" : "%d", horizontes[h]);
+    }
+    for (size_t serie = 0; serie < sizeof(series) / sizeof(series[0]) && usado < tamanho; serie++) {
+        usado += snprintf(json + usado, tamanho - usado, "],\"%s\":[", series[serie].nome);
+        int modelo = series[serie].modelo;
+        for (int h = 0; h < NUM_HORIZONTES && usado < tamanho; h++) {
+            float valor = valores[modelo][h] + series[serie].sinal * margens[modelo][h];
+            usado += snprintf(json + usado, tamanho - usado, h ? ",%.2f" : "%.2f", valor);
+        }
+    }
+    if (usado < tamanho) usado += snprintf(json + usado, tamanho - usado, "]}");
+    return usado < tamanho ? usado : tamanho - 1;
+}
+
+// Último intervalo fechado de cada camada: {"minuto":{...},"hora":{...},"dia":{...}}, null se ainda não houver
+static size_t formatar_resumo_historico(char *json, size_t tamanho) {
+    static const char *const nomes[NUM_NIVEIS_HISTORICO] = { "minuto", "hora", "dia" };
+    size_t usado = snprintf(json, tamanho, "{");
+    for (int nivel = 0; nivel < NUM_NIVEIS_HISTORICO && usado < tamanho; nivel++) {
+        Agregado_t agregado;
+        uint32_t inicio_s;
+        usado += snprintf(json + usado, tamanho - usado, nivel ? ",\"%s\":" : "\"%s\":", nomes[nivel]);
+        if (usado >= tamanho) break;
+        if (ler_historico(nivel, 1, &agregado, &inicio_s) && agregado.contagem) {
+            usado += snprintf(json + usado, tamanho - usado,
+                              "{\"inicio_s\":%lu,\"n\":%lu,\"min\":%.2f,\"max\":%.2f,\"media\":%.2f,\"ultimo\":%.2f}",
+                              (unsigned long)inicio_s, (unsigned long)agregado.contagem, agregado.minimo / 100.0f,
+                              agregado.maximo / 100.0f, historico_media(&agregado), agregado.ultimo / 100.0f);
+        } else {
+            usado += snprintf(json + usado, tamanho - usado, "null");
+        }
+    }
+    if (usado < tamanho) usado += snprintf(json + usado, tamanho - usado, "}");
+    return usado < tamanho ? usado : tamanho - 1;
+}
+
+static void lote_adicionar(LoteAmostras_t *lote, uint64_t marca_us, float temperatura) {
+    int posicao = (lote->inicio + lote->quantidade) % AMOSTRAS_POR_LOTE;
+    if (lote->quantidade < AMOSTRAS_POR_LOTE) lote->quantidade++;
+    else lote->inicio = (lote->inicio + 1) % AMOSTRAS_POR_LOTE;
+    lote->marca_us[posicao] = marca_us;
+    lote->temperatura[posicao] = temperatura;
+}
+
+// {"utc_us":[...],"temperatura":[...]} com as leituras do lote, da mais antiga à mais recente. Lotes
+// seguidos se sobrepõem: o assinante descarta as marcas que já viu. 0 sem hora SNTP
+static size_t formatar_amostras(const LoteAmostras_t *lote, char *json, size_t tamanho) {
+    if (!lote->quantidade || !utc_de(lote->marca_us[lote->inicio])) return 0;
+    size_t usado = snprintf(json, tamanho, "{\"utc_us\":[");
+    for (int i = 0; i < lote->quantidade && usado < tamanho; i++) {
+        uint64_t utc_us = utc_de(lote->marca_us[(lote->inicio + i) % AMOSTRAS_POR_LOTE]);
+        usado += snprintf(json + usado, tamanho - usado, i ? ",%llu" : "%llu", (unsigned long long)utc_us);
+    }
+    if (usado < tamanho) usado += snprintf(json + usado, tamanho - usado, "],\"temperatura\":[");
+    for (int i = 0; i < lote->quantidade && usado < tamanho; i++) {
+        float temperatura = lote->temperatura[(lote->inicio + i) % AMOSTRAS_POR_LOTE];
+        usado += snprintf(json + usado, tamanho - usado, i ? ",%.2f" : "%.2f", temperatura);
+    }
+    if (usado < tamanho) usado += snprintf(json + usado, tamanho - usado, "]}");
+    return usado < tamanho ? usado : tamanho - 1;
+}
+
+// Envia o que a janela e o anel de saída comportam, na ordem do agendador. Sem conexão, os valores
+// esperam (a telemetria até expirar)
+static void despachar_publicacoes(void) {
+    cyw43_arch_lwip_begin();
+    if (mqtt_state.conectado && mqtt_client_is_connected(mqtt_state.inst)) {
+        uint32_t agora = agora_ms();
+        int id;
+        while ((id = agendador_proximo(&agendador, agora, espaco_saida_mqtt())) >= 0) {
+            const TopicoAgendado_t *topico = &agendador.topicos[id];
+            err_t erro = mqtt_publish(mqtt_state.inst, topico_completo(topico->sufixo), agendador_dados(&agendador, id),
+                                      topico->tamanho, topico->qos, topico->retain, callback_publicacao,
+                                      (void *)(intptr_t)id);
+            if (erro != ERR_OK) {
+                agendador_recusado(&agendador);
+                break;
+            }
+            agendador_enviado(&agendador, id, agora);
+        }
+    }
+    cyw43_arch_lwip_end();
+}
+
+// {"enfileiradas":N,...,"janela":N,"confirmacao_ms":N}
+static size_t formatar_contadores_publicacao(char *json, size_t tamanho) {
+    cyw43_arch_lwip_begin();
+    ContadoresAgendador_t contadores = agendador.contadores;
+    unsigned janela = agendador.janela;
+    unsigned long confirmacao_ms = agendador.confirmacao_ms;
+    cyw43_arch_lwip_end();
+    int usado = snprintf(json, tamanho,
+                         "{\"enfileiradas\":%lu,\"coalescidas\":%lu,\"descartadas\":%lu,\"enviadas\":%lu,"
+                         "\"confirmadas\":%lu,\"falhas\":%lu,\"recusadas\":%lu,\"janela\":%u,\"confirmacao_ms\":%lu}",
+                         (unsigned long)contadores.enfileiradas, (unsigned long)contadores.coalescidas,
+                         (unsigned long)contadores.descartadas, (unsigned long)contadores.enviadas,
+                         (unsigned long)contadores.confirmadas, (unsigned long)contadores.falhas,
+                         (unsigned long)contadores.recusadas, janela, confirmacao_ms);
+    return (size_t)usado < tamanho ? (size_t)usado : tamanho - 1;
+}
+
+// Um ciclo de telemetria: um valor por tópico, que substitui o anterior se ele ainda não saiu
+static void enfileirar_telemetria(const EstadoSistema_t *estado, const LoteAmostras_t *lote) {
+    char buffer[16];
+
+    // Temperatura atual
+    snprintf(buffer, sizeof(buffer), "%.2f", estado->temperatura_atual);
+    enfileirar_publicacao(TOPICO_TEMPERATURA, buffer, strlen(buffer), PRIORIDADE_TELEMETRIA);
+
+    // Previsão por regressão linear
+    snprintf(buffer, sizeof(buffer), "%.2f", estado->previsoes.previsao_linear[HORIZONTE_PADRAO]);
+    enfileirar_publicacao(TOPICO_PREVISAO_LINEAR, buffer, strlen(buffer), PRIORIDADE_TELEMETRIA);
+
+    // Previsão Holt
+    snprintf(buffer, sizeof(buffer), "%.2f", estado->previsoes.previsao_holt[HORIZONTE_PADRAO]);
+    enfileirar_publicacao(TOPICO_PREVISAO_HOLT, buffer, strlen(buffer), PRIORIDADE_TELEMETRIA);
+
+    // Todos os horizontes de uma vez, com a hora UTC da leitura que os originou
+    char json[TAMANHO_JSON_PREVISOES];
+    size_t tamanho = formatar_previsoes(&estado->previsoes, utc_de(estado->marca_us), json, sizeof(json));
+    enfileirar_publicacao(TOPICO_PREVISOES, json, tamanho, PRIORIDADE_TELEMETRIA);
+
+    // Últimas leituras, cada uma com a sua hora UTC
+    _Static_assert(TAMANHO_JSON_AMOSTRAS <= TAMANHO_JSON_PREVISOES, "/amostras não cabe no buffer");
+    tamanho = formatar_amostras(lote, json, TAMANHO_JSON_AMOSTRAS);
+    if (tamanho) enfileirar_publicacao(TOPICO_AMOSTRAS, json, tamanho, PRIORIDADE_TELEMETRIA);
+
+    // Tempo até a urgência por modelo ({"linear_s":N|null,"holt_s":N|null})
+    char eta[48], eta_linear[12] = "null", eta_holt[12] = "null";
+    if (estado->eta_linear_s >= 0) snprintf(eta_linear, sizeof(eta_linear), "%ld", lroundf(estado->eta_linear_s));
+    if (estado->eta_holt_s >= 0) snprintf(eta_holt, sizeof(eta_holt), "%ld", lroundf(estado->eta_holt_s));
+    snprintf(eta, sizeof(eta), "{\"linear_s\":%s,\"holt_s\":%s}", eta_linear, eta_holt);
+    enfileirar_publicacao(TOPICO_TEMPO_ATE_URGENCIA, eta, strlen(eta), PRIORIDADE_TELEMETRIA);
+
+    // Contadores do filtro de discrepantes
+    char rejeicoes[96];
+    snprintf(rejeicoes, sizeof(rejeicoes), "{\"aceitas\":%lu,\"discrepantes\":%lu,\"valor_reset\":%lu}",
+             (unsigned long)estado->rejeicoes.aceitas, (unsigned long)estado->rejeicoes.discrepantes,
+             (unsigned long)estado->rejeicoes.valor_reset);
+    enfileirar_publicacao(TOPICO_AMOSTRAS_REJEITADAS, rejeicoes, strlen(rejeicoes), PRIORIDADE_TELEMETRIA);
+
+    // Resumo do histórico de longo prazo
+    tamanho = formatar_resumo_historico(json, sizeof(json));
+    enfileirar_publicacao(TOPICO_HISTORICO_RESUMO, json, tamanho, PRIORIDADE_TELEMETRIA);
+
+    // Contadores do próprio agendador
+    tamanho = formatar_contadores_publicacao(json, sizeof(json));
+    enfileirar_publicacao(TOPICO_PUBLICACAO, json, tamanho, PRIORIDADE_TELEMETRIA);
+
+    // Situação e ponto de regulagem não expiram: o último valor sai mesmo após uma reconexão
+    const char *situacao = NOMES_ALERTA[estado->nivel_alerta];
+    enfileirar_publicacao(TOPICO_ESTADO, situacao, strlen(situacao), PRIORIDADE_ESTADO);
+    snprintf(buffer, sizeof(buffer), "%d", estado->temperatura_urgencia);
+    enfileirar_publicacao(TOPICO_PONTO_REGULAGEM, buffer, strlen(buffer), PRIORIDADE_ESTADO);
 }
 
 static void tarefa_publicar_mqtt(void *param) {
     (void)param;
+    EstadoSistema_t estado;
+    bool estado_recebido = false;
+    static LoteAmostras_t lote;
+    while (!mqtt_state.cyw43_pronto) vTaskDelay(pdMS_TO_TICKS(INTERVALO_DESPACHO_MS)); // O agendador vive sob o lock do lwIP
+    TickType_t proxima_publicacao = xTaskGetTickCount();
     while (1) {
-        if (mqtt_state.conectado && mqtt_client_is_connected(mqtt_state.inst)) {
-            EstadoSistema_t estado;
-            ler_estado(&estado);
-            char buffer[16];
-
-            // Publica temperatura atual
-            snprintf(buffer, sizeof(buffer), "%.2f", estado.temperatura_atual);
-            mqtt_publish(mqtt_state.inst, topico_completo("/temperatura"), buffer, strlen(buffer),
-                         MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, callback_publicacao, NULL);
-
-            // Publica previsão por regressão linear
-            snprintf(buffer, sizeof(buffer), "%.2f", estado.temperatura_prevista);
-            mqtt_publish(mqtt_state.inst, topico_completo("/temperatura_previsao_regressao_linear"), buffer, strlen(buffer),
-                         MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, callback_publicacao, NULL);
-
-            // Publica previsão Holt
-            snprintf(buffer, sizeof(buffer), "%.2f", estado.temperatura_prevista_holt);
-            mqtt_publish(mqtt_state.inst, topico_completo("/temperatura_previsao_holt"), buffer, strlen(buffer),
-                         MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, callback_publicacao, NULL);
-
-            // Publica situacao
-            const char *situacao = determinar_situacao(estado.temperatura_atual, estado.temperatura_prevista, estado.temperatura_urgencia);
-            mqtt_publish(mqtt_state.inst, topico_completo("/estado"), situacao, strlen(situacao),
-                         MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, callback_publicacao, NULL);
-
-            // Publica ponto de regulagem
-            snprintf(buffer, sizeof(buffer), "%d", estado.temperatura_urgencia);
-            mqtt_publish(mqtt_state.inst, topico_completo("/ponto_de_regulagem"), buffer, strlen(buffer),
-                         MQTT_PUBLISH_QOS, MQTT_PUBLISH_RETAIN, callback_publicacao, NULL);
+        // Até a próxima publicação periódica, alarmes entram na fila assim que chegam e leituras vão
+        // para o lote; com valores retidos pela janela ou pelo anel de saída, acorda a cada
+        // INTERVALO_DESPACHO_MS para tentar de novo
+        Evento_t evento;
+        TickType_t agora = xTaskGetTickCount();
+        TickType_t espera = (int32_t)(proxima_publicacao - agora) > 0 ? proxima_publicacao - agora : 0;
+        cyw43_arch_lwip_begin();
+        bool pendentes = agendador_pendentes(&agendador) > 0;
+        cyw43_arch_lwip_end();
+        if (pendentes) espera = MIN(espera, pdMS_TO_TICKS(INTERVALO_DESPACHO_MS));
+        if (xQueueReceive(fila_eventos_mqtt, &evento, espera) == pdTRUE) {
+            if (evento.tipo == EVENTO_AMOSTRA) {
+                lote_adicionar(&lote, evento.amostra.marca_us, evento.amostra.temperatura); // Sai na próxima publicação periódica
+            } else {
+                const char *situacao = NOMES_ALERTA[evento.alarme.nivel];
+                enfileirar_publicacao(TOPICO_ESTADO, situacao, strlen(situacao), PRIORIDADE_ALARME);
+            }
+        } else if ((int32_t)(xTaskGetTickCount() - proxima_publicacao) >= 0) {
+            proxima_publicacao += pdMS_TO_TICKS(TEMP_PUBLISH_INTERVAL_S * 1000);
+
+            // Consome os instantâneos pendentes e fica com o mais recente
+            while (fila_spsc_receber(&fila_publicacao, &estado)) {
+                estado_recebido = true;
+            }
+            if (estado_recebido) enfileirar_telemetria(&estado, &lote);
+        }
+        despachar_publicacoes();
+    }
+}
+
+/*============================================================================
+ * TAREFA: CONSULTA DE HISTÓRICO VIA MQTT
+ * Responde a "/historico/pedido" ("id minuto|hora|dia inicio_s fim_s") com
+ * páginas binárias em "/historico/resposta", uma por vez: a próxima só é
+ * codificada quando o broker confirma a anterior.
+ *
+ * Página (little-endian): versão u8, nível u8, id u16, página u16,
+ * total de páginas u16, período_s u32, início_s do primeiro registro u32,
+ * registros u16, seguidos dos registros de historico_codificar.
+ *===========================================================================*/
+
+// Interpreta o pedido e entrega à tarefa de resposta; descartado se houver outros na fila
+static void enfileirar_pedido_historico(const char *texto) {
+    static const char *const nomes[NUM_NIVEIS_HISTORICO] = { "minuto", "hora", "dia" };
+    PedidoHistorico_t pedido;
+    unsigned id;
+    unsigned long inicio_s, fim_s;
+    char nome[8];
+    if (sscanf(texto, "%u %7s %lu %lu", &id, nome, &inicio_s, &fim_s) != 4) {
+        LOG_AVISO("Pedido de histórico inválido: %s", texto);
+        return;
+    }
+    int nivel = 0;
+    while (nivel < NUM_NIVEIS_HISTORICO && strcmp(nome, nomes[nivel]) != 0) nivel++;
+    if (nivel == NUM_NIVEIS_HISTORICO) {
+        LOG_AVISO("Camada de histórico desconhecida: %s", nome);
+        return;
+    }
+    pedido = (PedidoHistorico_t){ .id = (uint16_t)id, .nivel = nivel, .inicio_s = inicio_s, .fim_s = fim_s };
+    if (xQueueSend(fila_pedidos_historico, &pedido, 0) != pdTRUE) LOG_AVISO("Consulta de histórico descartada");
+}
+
+// Confirmação (PUBACK) de uma página: libera a próxima
+static void callback_pagina_historico(void *arg, err_t erro) {
+    (void)arg;
+    xTaskNotify(tarefa_historico, erro == ERR_OK ? 1 : 2, eSetValueWithOverwrite);
+}
+
+static void tarefa_responder_historico(void *param) {
+    (void)param;
+    // Uma página por vez: os registros saem direto dos anéis do histórico para este buffer
+    static uint8_t pagina[BYTES_CABECALHO_HISTORICO + REGISTROS_POR_PAGINA_HISTORICO * HISTORICO_BYTES_REGISTRO];
+    // Tópico próprio: o buffer de topico_completo é dos callbacks do lwIP
+    char topico[MQTT_TOPIC_LEN];
+    snprintf(topico, sizeof(topico), MQTT_TOPIC_BASE "/historico/resposta");
+    PedidoHistorico_t pedido;
+    while (1) {
+        xQueueReceive(fila_pedidos_historico, &pedido, portMAX_DELAY);
+        uint32_t primeiro_s = 0, periodo_s = 0;
+        int total = 0;
+        if (xSemaphoreTake(mutex_historico, portMAX_DELAY)) {
+            total = historico_contar(&historico, pedido.nivel, pedido.inicio_s, pedido.fim_s, &primeiro_s);
+            periodo_s = historico.camadas[pedido.nivel].periodo_s;
+            xSemaphoreGive(mutex_historico);
+        }
+        // Sem registros, uma página vazia avisa o cliente que o pedido foi atendido
+        int paginas = MAX((total + REGISTROS_POR_PAGINA_HISTORICO - 1) / REGISTROS_POR_PAGINA_HISTORICO, 1);
+        for (int numero = 0; numero < paginas; numero++) {
+            int registros = MIN(total - numero * REGISTROS_POR_PAGINA_HISTORICO, REGISTROS_POR_PAGINA_HISTORICO);
+            uint32_t inicio_s = primeiro_s + (uint32_t)(numero * REGISTROS_POR_PAGINA_HISTORICO) * periodo_s;
+            uint8_t *p = pagina;
+            *p++ = 1; // Versão do formato
+            *p++ = (uint8_t)pedido.nivel;
+            p = historico_escrever16(p, pedido.id);
+            p = historico_escrever16(p, (uint16_t)numero);
+            p = historico_escrever16(p, (uint16_t)paginas);
+            p = historico_escrever32(p, periodo_s);
+            p = historico_escrever32(p, inicio_s);
+            p = historico_escrever16(p, (uint16_t)MAX(registros, 0));
+            if (registros > 0 && xSemaphoreTake(mutex_historico, portMAX_DELAY)) {
+                p += historico_codificar(&historico, pedido.nivel, inicio_s, registros, p);
+                xSemaphoreGive(mutex_historico);
+            }
+
+            // Anel de saída cheio (ex.: durante a publicação periódica): tenta de novo em seguida.
+            // O cliente MQTT só é tocado com o lock do lwIP, como no resto do código
+            err_t erro = ERR_CONN;
+            for (int tentativa = 0; tentativa < TENTATIVAS_PAGINA_HISTORICO; tentativa++) {
+                xTaskNotifyStateClear(NULL);
+                cyw43_arch_lwip_begin();
+                if (mqtt_state.conectado && mqtt_client_is_connected(mqtt_state.inst)) {
+                    erro = mqtt_publish(mqtt_state.inst, topico, pagina, p - pagina, MQTT_PUBLISH_QOS, 0,
+                                        callback_pagina_historico, NULL);
+                } else {
+                    erro = ERR_CONN;
+                }
+                cyw43_arch_lwip_end();
+                if (erro != ERR_MEM) break;
+                vTaskDelay(pdMS_TO_TICKS(INTERVALO_POLL_CYW43_MS * 2));
+            }
+            uint32_t confirmacao = 0;
+            if (erro != ERR_OK ||
+                xTaskNotifyWait(0, UINT32_MAX, &confirmacao, pdMS_TO_TICKS(TIMEOUT_PAGINA_HISTORICO_MS)) != pdTRUE ||
+                confirmacao != 1) {
+                LOG_AVISO("Consulta de histórico %u interrompida na página %d (erro %d)", pedido.id, numero, erro);
+                break;
+            }
         }
-        vTaskDelay(pdMS_TO_TICKS(TEMP_PUBLISH_INTERVAL_S * 1000));
     }
 }
 
@@ -560,12 +1662,16 @@ static void tarefa_publicar_mqtt(void *param) {
 // Processa dados recebidos
 static void processar_dados_recebidos(void *arg, const u8_t *dados, u16_t tamanho, u8_t flags) {
     EstadoMQTT_t *estado = (EstadoMQTT_t*)arg;
-    strncpy(estado->data, (const char*)dados, MIN(tamanho, sizeof(estado->data) - 1));
+    tamanho = MIN(tamanho, sizeof(estado->data) - 1);
+    memcpy(estado->data, dados, tamanho);
     estado->data[tamanho] = '\0';
-    if (strcmp(estado->topic, topico_completo("/led")) == 0) {
+    if (strcmp(estado->topic, topico_completo("/historico/pedido")) == 0) {
+        enfileirar_pedido_historico(estado->data);
+    } else if (strcmp(estado->topic, topico_completo("/led")) == 0) {
         bool ligado = (!strcasecmp(estado->data, "on") || !strcmp(estado->data, "1"));
         cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, ligado);
     } else if (strcmp(estado->topic, topico_completo("/exit")) == 0) {
+        estado->encerrado = true;
         mqtt_disconnect(estado->inst);
     }
 }
@@ -579,23 +1685,199 @@ static void registrar_topico(void *arg, const char *topico, u32_t tamanho) {
 
 // Callback para subscrição
 static void callback_subscricao(void *arg, err_t erro) {
-    if (erro) printf("Erro de subscrição MQTT: %d\n", erro);
+    if (erro) LOG_ERRO("Erro de subscrição MQTT: %d", erro);
+}
+
+#ifdef MQTT_CERT_INC
+// Guarda a sessão recém-negociada para a próxima conexão. Retorna true se o handshake foi abreviado:
+// ao retomar, o segredo mestre é o da sessão oferecida; um handshake completo gera outro
+static bool registrar_sessao_tls(EstadoMQTT_t *estado) {
+    mbedtls_ssl_context *ssl = altcp_tls_context(estado->inst->conn);
+    mbedtls_ssl_session nova;
+    mbedtls_ssl_session_init(&nova);
+    if (!ssl || mbedtls_ssl_get_session(ssl, &nova) != 0) {
+        mbedtls_ssl_session_free(&nova);
+        estado->handshakes_completos++;
+        return false;
+    }
+    bool retomada = estado->sessao_tls_valida && !memcmp(nova.master, estado->sessao_tls.master, sizeof(nova.master));
+    mbedtls_ssl_session_free(&estado->sessao_tls);
+    estado->sessao_tls = nova; // A cópia assume o ticket e o certificado alocados em 'nova'
+    estado->sessao_tls_valida = true;
+    if (retomada) estado->handshakes_retomados++;
+    else estado->handshakes_completos++;
+    return retomada;
 }
+#endif
 
 // Callback para conexão
 static void callback_conexao(mqtt_client_t *cliente, void *arg, mqtt_connection_status_t status) {
     EstadoMQTT_t *estado = (EstadoMQTT_t*)arg;
+    estado->conectando = false;
     if (status == MQTT_CONNECT_ACCEPTED) {
-        printf("Conexão MQTT estabelecida\n");
+        uint32_t agora = agora_ms(), duracao_ms = agora - estado->inicio_conexao_ms;
+        (void)duracao_ms; // Só usado pelo log
+#ifdef MQTT_CERT_INC
+        bool sessao_retomada = registrar_sessao_tls(estado);
+        (void)sessao_retomada;
+        LOG_INFO("Conexão MQTT/TLS estabelecida em %lu ms (handshake %s; %lu completos, %lu retomados)",
+                 (unsigned long)duracao_ms, sessao_retomada ? "retomado" : "completo",
+                 (unsigned long)estado->handshakes_completos, (unsigned long)estado->handshakes_retomados);
+#else
+        LOG_INFO("Conexão MQTT estabelecida em %lu ms", (unsigned long)duracao_ms);
+#endif
         estado->conectado = true;
+        estado->espera_reconexao_ms = RECONEXAO_MIN_MS;
+        if (!estado->marco_conexao_ms) estado->marco_conexao_ms = agora;
+        estado->gravar_rede = true;
         mqtt_sub_unsub(cliente, topico_completo("/led"), MQTT_SUBSCRIBE_QOS, callback_subscricao, estado, true);
         mqtt_sub_unsub(cliente, topico_completo("/print"), MQTT_SUBSCRIBE_QOS, callback_subscricao, estado, true);
         mqtt_sub_unsub(cliente, topico_completo("/ping"), MQTT_SUBSCRIBE_QOS, callback_subscricao, estado, true);
         mqtt_sub_unsub(cliente, topico_completo("/exit"), MQTT_SUBSCRIBE_QOS, callback_subscricao, estado, true);
-        mqtt_publish(cliente, topico_completo("/online"), "1", 1, MQTT_WILL_QOS, true, callback_publicacao, NULL);
+        mqtt_sub_unsub(cliente, topico_completo("/historico/pedido"), MQTT_SUBSCRIBE_QOS, callback_subscricao, estado, true);
+        // Já no contexto do lwIP (com o lock): entra direto no agendador, à frente da telemetria
+        agendador_enfileirar(&agendador, TOPICO_ONLINE, "1", 1, PRIORIDADE_ESTADO, 0, agora);
     } else {
-        printf("Conexão MQTT perdida: %d\n", status);
+        agendador_desconectado(&agendador);
+        LOG_AVISO("Conexão MQTT perdida: %d (nova tentativa em %lu ms)", status, (unsigned long)estado->espera_reconexao_ms);
         estado->conectado = false;
+        estado->proxima_tentativa_ms = agora_ms() + estado->espera_reconexao_ms;
+        estado->espera_reconexao_ms = MIN(estado->espera_reconexao_ms * 2, RECONEXAO_MAX_MS);
+        if (estado->broker_salvo && !estado->marco_conexao_ms) {
+            estado->broker_salvo = false; // O endereço salvo pode ter mudado: a próxima tentativa consulta o DNS
+            estado->broker_resolvido = false;
+        }
+    }
+}
+
+// Abre a conexão com o broker. Com TLS, a mesma altcp_tls_config é reaproveitada e a sessão anterior é
+// oferecida antes do handshake, que o servidor pode abreviar (sem ECDHE/RSA). O lock do lwIP impede
+// que o handshake comece antes de a sessão ser definida
+static void iniciar_conexao_mqtt(EstadoMQTT_t *estado) {
+    estado->inicio_conexao_ms = agora_ms();
+    cyw43_arch_lwip_begin();
+    err_t erro = mqtt_client_connect(estado->inst, &estado->server_addr, MQTT_PORTA, callback_conexao, estado, &estado->info);
+#ifdef MQTT_CERT_INC
+    if (erro == ERR_OK) {
+        mbedtls_ssl_context *ssl = altcp_tls_context(estado->inst->conn);
+        mbedtls_ssl_set_hostname(ssl, MQTT_SERVER); // SNI e verificação do nome no certificado
+        if (estado->sessao_tls_valida && mbedtls_ssl_set_session(ssl, &estado->sessao_tls) != 0) {
+            estado->sessao_tls_valida = false; // Sessão recusada localmente: próximo handshake completo
+        }
+    }
+#endif
+    cyw43_arch_lwip_end();
+    if (erro == ERR_OK) {
+        estado->conectando = true;
+    } else {
+        LOG_ERRO("Erro ao conectar ao MQTT: %d", erro);
+        estado->proxima_tentativa_ms = agora_ms() + estado->espera_reconexao_ms;
+        estado->espera_reconexao_ms = MIN(estado->espera_reconexao_ms * 2, RECONEXAO_MAX_MS);
+    }
+}
+
+/*============================================================================
+ * REDE SALVA E CONEXÃO RÁPIDA
+ * O último AP (BSSID e canal), a concessão DHCP e o endereço do broker ficam
+ * na flash. No boot, a associação vai direto ao AP salvo, a concessão é
+ * adotada sem esperar o DHCP e o broker dispensa o DNS; qualquer falha cai
+ * no caminho completo (varredura, DHCP e DNS).
+ *===========================================================================*/
+
+static uint32_t assinatura_rede(void) {
+    return persistencia_crc32(persistencia_crc32(0, WIFI_SSID, strlen(WIFI_SSID)), MQTT_SERVER, strlen(MQTT_SERVER));
+}
+
+static bool carregar_rede(RedeSalva_t *rede) {
+    return persistencia_ler(AREA_REDE, rede, sizeof(*rede)) && rede->versao == VERSAO_REDE_SALVA &&
+           rede->assinatura == assinatura_rede() && rede->ip != 0;
+}
+
+// Associação direta ao BSSID salvo, sondando só o canal salvo, e adoção da concessão anterior. O DHCP
+// continua em segundo plano: se trouxer outro endereço, a conexão MQTT cai e é refeita pelo laço da tarefa
+static bool conectar_wifi_rapido(const RedeSalva_t *rede) {
+    cyw43_arch_lwip_begin();
+    int erro = cyw43_wifi_join(&cyw43_state, strlen(WIFI_SSID), (const uint8_t *)WIFI_SSID, strlen(WIFI_PASSWORD),
+                               (const uint8_t *)WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, rede->bssid,
+                               rede->canal ? rede->canal : CYW43_CHANNEL_NONE);
+    cyw43_arch_lwip_end();
+    uint32_t limite = agora_ms() + TIMEOUT_WIFI_RAPIDO_MS;
+    int enlace;
+    while (!erro && (enlace = cyw43_wifi_link_status(&cyw43_state, CYW43_ITF_STA)) != CYW43_LINK_JOIN) {
+        if (enlace < 0 || (int32_t)(agora_ms() - limite) >= 0) erro = enlace < 0 ? enlace : -1;
+        else vTaskDelay(pdMS_TO_TICKS(INTERVALO_ESPERA_WIFI_MS));
+    }
+    if (erro) {
+        cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+        return false;
+    }
+    ip4_addr_t ip, mascara, gateway;
+    ip4_addr_set_u32(&ip, rede->ip);
+    ip4_addr_set_u32(&mascara, rede->mascara);
+    ip4_addr_set_u32(&gateway, rede->gateway);
+    cyw43_arch_lwip_begin();
+    netif_set_addr(&cyw43_state.netif[CYW43_ITF_STA], &ip, &mascara, &gateway);
+    cyw43_arch_lwip_end();
+    return true;
+}
+
+// Grava o acesso atual se ele mudou (a flash só é escrita quando o AP, o endereço ou o broker mudam)
+static void salvar_rede(RedeSalva_t *salva) {
+    RedeSalva_t atual = { .versao = VERSAO_REDE_SALVA, .assinatura = assinatura_rede() };
+    uint32_t canal[3] = { 0 }; // channel_info_t: canal em uso, canal alvo e canal da varredura
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+    cyw43_arch_lwip_begin();
+    bool valido = cyw43_wifi_get_bssid(&cyw43_state, atual.bssid) == 0 &&
+                  cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(canal), (uint8_t *)canal, CYW43_ITF_STA) == 0;
+    atual.ip = ip4_addr_get_u32(netif_ip4_addr(netif));
+    atual.mascara = ip4_addr_get_u32(netif_ip4_netmask(netif));
+    atual.gateway = ip4_addr_get_u32(netif_ip4_gw(netif));
+    atual.broker = ip4_addr_get_u32(ip_2_ip4(&mqtt_state.server_addr));
+    cyw43_arch_lwip_end();
+    atual.canal = (uint16_t)canal[0];
+    if (!valido || !memcmp(&atual, salva, sizeof(atual))) return;
+    bool gravado = false;
+    if (xSemaphoreTake(mutex_flash, portMAX_DELAY)) {
+        gravado = persistencia_gravar(AREA_REDE, &atual, sizeof(atual));
+        xSemaphoreGive(mutex_flash);
+    }
+    if (gravado) {
+        *salva = atual;
+        LOG_INFO("Rede salva na flash (canal %u, IP %s)", atual.canal, ip4addr_ntoa(netif_ip4_addr(netif)));
+    } else {
+        LOG_AVISO("Falha ao gravar a rede na flash");
+    }
+}
+
+// Resposta do DNS (contexto do lwIP)
+static void callback_dns(const char *nome, const ip_addr_t *endereco, void *arg) {
+    (void)nome;
+    EstadoMQTT_t *estado = (EstadoMQTT_t*)arg;
+    if (endereco) {
+        estado->server_addr = *endereco;
+        estado->broker_resolvido = true;
+        LOG_INFO("Broker MQTT: %s", ipaddr_ntoa(endereco));
+    } else {
+        LOG_AVISO("DNS sem resposta para %s (nova tentativa em %lu ms)", MQTT_SERVER, (unsigned long)estado->espera_reconexao_ms);
+        estado->proxima_tentativa_ms = agora_ms() + estado->espera_reconexao_ms;
+        estado->espera_reconexao_ms = MIN(estado->espera_reconexao_ms * 2, RECONEXAO_MAX_MS);
+    }
+    estado->resolvendo = false;
+}
+
+// Inicia a resolução de MQTT_SERVER; um IP literal ou um nome no cache do lwIP resolve na hora
+static void resolver_broker(EstadoMQTT_t *estado) {
+    cyw43_arch_lwip_begin();
+    err_t erro = dns_gethostbyname(MQTT_SERVER, &estado->server_addr, callback_dns, estado);
+    estado->resolvendo = (erro == ERR_INPROGRESS);
+    cyw43_arch_lwip_end();
+    if (erro == ERR_OK) {
+        estado->broker_resolvido = true;
+        LOG_INFO("Broker MQTT: %s", ipaddr_ntoa(&estado->server_addr));
+    } else if (erro != ERR_INPROGRESS) {
+        LOG_ERRO("Erro ao resolver %s: %d", MQTT_SERVER, erro);
+        estado->proxima_tentativa_ms = agora_ms() + estado->espera_reconexao_ms;
+        estado->espera_reconexao_ms = MIN(estado->espera_reconexao_ms * 2, RECONEXAO_MAX_MS);
     }
 }
 
@@ -606,16 +1888,34 @@ static void callback_conexao(mqtt_client_t *cliente, void *arg, mqtt_connection_
 static void tarefa_conectar_wifi_mqtt(void *param) {
     (void)param;
     if (cyw43_arch_init()) {
-        printf("Erro ao inicializar CYW43\n");
+        LOG_ERRO("Erro ao inicializar CYW43");
         vTaskDelete(NULL);
     }
+    mqtt_state.cyw43_pronto = true;
     cyw43_arch_enable_sta_mode();
-    printf("Conectando ao Wi-Fi %s...\n", WIFI_SSID);
-    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 30000)) {
-        printf("Falha na conexão Wi-Fi\n");
-        vTaskDelete(NULL);
+    static RedeSalva_t rede_salva;
+    bool tem_rede_salva = carregar_rede(&rede_salva);
+    LOG_INFO("Conectando ao Wi-Fi %s%s...", WIFI_SSID, tem_rede_salva ? " (AP salvo)" : "");
+    mqtt_state.wifi_rapido = tem_rede_salva && conectar_wifi_rapido(&rede_salva);
+    if (!mqtt_state.wifi_rapido) {
+        if (tem_rede_salva) LOG_AVISO("AP salvo não respondeu: varrendo os canais");
+        if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, TIMEOUT_WIFI_MS)) {
+            LOG_ERRO("Falha na conexão Wi-Fi");
+            vTaskDelete(NULL);
+        }
     }
-    printf("IP atribuído: %s\n", ipaddr_ntoa(&(netif_list->ip_addr)));
+    mqtt_state.marco_wifi_ms = agora_ms();
+    LOG_INFO("IP atribuído: %s", ip4addr_ntoa(netif_ip4_addr(&cyw43_state.netif[CYW43_ITF_STA])));
+    // Hora UTC das leituras: o SNTP consulta o servidor agora e a cada SNTP_UPDATE_DELAY, mesmo após quedas do Wi-Fi
+    cyw43_arch_lwip_begin();
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, SNTP_SERVIDOR);
+    sntp_init();
+    cyw43_arch_lwip_end();
+#if PERFIL_BAIXO_CONSUMO
+    // Rádio dorme entre beacons; as publicações a cada 10 s acordam o link sob demanda
+    cyw43_wifi_pm(&cyw43_state, CYW43_AGGRESSIVE_PM);
+#endif
     mqtt_state.inst = mqtt_client_new();
     if (!mqtt_state.inst) {
         vTaskDelete(NULL);
@@ -629,24 +1929,56 @@ static void tarefa_conectar_wifi_mqtt(void *param) {
     mqtt_state.info.keep_alive = MQTT_KEEP_ALIVE_S;
     mqtt_state.info.client_user = MQTT_USERNAME;
     mqtt_state.info.client_pass = MQTT_PASSWORD;
-    mqtt_state.info.will_topic = topico_completo("/online");
+    // Buffer próprio: info.will_topic é lido a cada conexão, e o de topico_completo é reescrito por outros tópicos
+    static char topico_vontade[MQTT_TOPIC_LEN];
+    snprintf(topico_vontade, sizeof(topico_vontade), MQTT_TOPIC_BASE MQTT_WILL_TOPIC);
+    mqtt_state.info.will_topic = topico_vontade;
     mqtt_state.info.will_msg = MQTT_WILL_MSG;
     mqtt_state.info.will_qos = MQTT_WILL_QOS;
     mqtt_state.info.will_retain = true;
-    if (dns_gethostbyname(MQTT_SERVER, &mqtt_state.server_addr, NULL, NULL) != ERR_OK) {
-        while (dns_gethostbyname(MQTT_SERVER, &mqtt_state.server_addr, NULL, NULL) == ERR_INPROGRESS) {
-            vTaskDelay(pdMS_TO_TICKS(500));
-        }
+    if (tem_rede_salva && rede_salva.broker) {
+        ip_addr_set_ip4_u32(&mqtt_state.server_addr, rede_salva.broker);
+        mqtt_state.broker_resolvido = mqtt_state.broker_salvo = true;
+        LOG_INFO("Broker MQTT: %s (salvo)", ipaddr_ntoa(&mqtt_state.server_addr));
     }
-    printf("Broker MQTT: %s\n", ipaddr_ntoa(&mqtt_state.server_addr));
+#ifdef MQTT_CERT_INC
+    // Uma configuração TLS (CA e gerador aleatório) para todas as conexões; cada reconexão só cria o contexto SSL
+    mqtt_state.info.tls_config = altcp_tls_create_config_client((const u8_t *)TLS_ROOT_CERT, sizeof(TLS_ROOT_CERT));
+    mbedtls_ssl_session_init(&mqtt_state.sessao_tls);
+#endif
     mqtt_set_inpub_callback(mqtt_state.inst, registrar_topico, processar_dados_recebidos, &mqtt_state);
-    if (mqtt_client_connect(mqtt_state.inst, &mqtt_state.server_addr, MQTT_PORT, callback_conexao, &mqtt_state, &mqtt_state.info) != ERR_OK) {
-        printf("Erro ao conectar ao MQTT\n");
-        vTaskDelete(NULL);
-    }
+    mqtt_state.espera_reconexao_ms = RECONEXAO_MIN_MS;
+    uint32_t espera_wifi_ms = RECONEXAO_MIN_MS, proxima_tentativa_wifi_ms = 0;
     while (1) {
         cyw43_arch_poll();
-        vTaskDelay(pdMS_TO_TICKS(10));
+        uint32_t agora = agora_ms();
+        int enlace = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        if (enlace != CYW43_LINK_UP) {
+            // Wi-Fi caiu: nova associação em segundo plano, com recuo exponencial. A conexão MQTT
+            // cai pelo keep-alive se a queda durar mais que ele e é refeita abaixo
+            if (enlace <= CYW43_LINK_DOWN && (int32_t)(agora - proxima_tentativa_wifi_ms) >= 0) {
+                LOG_AVISO("Wi-Fi fora do ar (%d): reassociando", enlace);
+                cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK);
+                proxima_tentativa_wifi_ms = agora + espera_wifi_ms;
+                espera_wifi_ms = MIN(espera_wifi_ms * 2, RECONEXAO_MAX_MS);
+            }
+        } else {
+            espera_wifi_ms = RECONEXAO_MIN_MS;
+            if (!mqtt_state.conectado && !mqtt_state.conectando && !mqtt_state.encerrado && !mqtt_state.resolvendo &&
+                (int32_t)(agora - mqtt_state.proxima_tentativa_ms) >= 0) {
+                if (!mqtt_state.broker_resolvido) {
+                    resolver_broker(&mqtt_state);
+                } else {
+                    if (!mqtt_state.marco_broker_ms) mqtt_state.marco_broker_ms = agora;
+                    iniciar_conexao_mqtt(&mqtt_state);
+                }
+            }
+            if (mqtt_state.gravar_rede) {
+                mqtt_state.gravar_rede = false;
+                salvar_rede(&rede_salva);
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(INTERVALO_POLL_CYW43_MS));
     }
 }
 
@@ -656,6 +1988,7 @@ static void tarefa_conectar_wifi_mqtt(void *param) {
  *===========================================================================*/
 int main(void) {
     stdio_init_all();
+    log_iniciar(agora_ms);
 
     // Inicialização do I2C para o display
     i2c_init(i2c1, 400 * 1000);
@@ -663,7 +1996,12 @@ int main(void) {
     gpio_set_function(PINO_SCL_I2C, GPIO_FUNC_I2C);
     gpio_pull_up(PINO_SDA_I2C);
     gpio_pull_up(PINO_SCL_I2C);
-    ssd1306_init(&display, 128, 64, false, 0x3C, i2c1);
+#if PERFIL_ESTATICO
+    static uint8_t buffer_display[SSD1306_BUFSIZE(128, 64)];
+    ssd1306_init_static(&display, 128, 64, false, 0x3C, i2c1, buffer_display);
+#else
+    if (!ssd1306_init(&display, 128, 64, false, 0x3C, i2c1)) LOG_ERRO("Sem memória para o display: seguindo sem ele");
+#endif
     ssd1306_config(&display);
 
     // Inicialização do ADC, botões, LEDs e buzzer
@@ -692,19 +2030,36 @@ int main(void) {
     ds18b20_init(PINO_DS18B20);
     inicializar_matriz_led();
 
+#if PERFIL_BAIXO_CONSUMO
+    iniciar_baixo_consumo();
+#endif
+
     // Infraestrutura do RTOS
-    mutex_estado = xSemaphoreCreateMutex();
-    mutex_display = xSemaphoreCreateMutex();
-    q_temp = xQueueCreate(10, sizeof(DadosTemperatura_t));
-    q_prev = xQueueCreate(10, sizeof(ResultadosPrevisao_t));
-    q_cmd = xQueueCreate(10, sizeof(ComandoUsuario_t));
-
-    // Criação das tarefas
-    xTaskCreate(tarefa_leitura_temperatura, "Temperatura", 1024, NULL, 2, NULL);
-    xTaskCreate(tarefa_entrada_usuario, "Entrada", 512, NULL, 1, NULL);
-    xTaskCreate(tarefa_atualizar_display, "Display", 1024, NULL, 1, NULL);
-    xTaskCreate(tarefa_conectar_wifi_mqtt, "WiFi_MQTT", 2048, NULL, 3, NULL);
-    xTaskCreate(tarefa_publicar_mqtt, "Publicacao_MQTT", 768, NULL, 1, NULL);
+    carregar_retomada();
+    estado_publicado = estado_sistema; // Instantâneo inicial, antes de existirem leitores
+    CRIAR_MUTEX(mutex_display);
+    CRIAR_MUTEX(mutex_flash);
+    CRIAR_MUTEX(mutex_historico);
+    CRIAR_FILA(fila_pedidos_historico, TAMANHO_FILA_PEDIDOS_HISTORICO, PedidoHistorico_t);
+    historico_iniciar(&historico, 0);
+    CRIAR_FILA(fila_display, TAMANHO_FILA_DISPLAY, Evento_t);
+    CRIAR_FILA(fila_eventos_mqtt, TAMANHO_FILA_EVENTOS_MQTT, Evento_t);
+    id_assinante_display = eventos_assinar_fila(EVENTO_MASCARA(EVENTO_AMOSTRA) | EVENTO_MASCARA(EVENTO_PREVISAO) |
+                                                EVENTO_MASCARA(EVENTO_COMANDO), fila_display);
+    id_assinante_mqtt = eventos_assinar_fila(EVENTO_MASCARA(EVENTO_ALARME) | EVENTO_MASCARA(EVENTO_AMOSTRA), fila_eventos_mqtt);
+    eventos_assinar_callback(EVENTO_MASCARA(EVENTO_COMANDO) | EVENTO_MASCARA(EVENTO_ALARME), registrar_evento, NULL);
+    fila_spsc_iniciar(&fila_publicacao, armazenamento_fila_publicacao, sizeof(EstadoSistema_t), CAPACIDADE_FILA_PUBLICACAO);
+    iniciar_agendador();
+
+    // Criação das tarefas (no perfil SMP, rede no núcleo 0 e tempo real no núcleo 1)
+    CRIAR_TAREFA(tarefa_leitura_temperatura, "Temperatura", 1024, 2, NUCLEO_TEMPO_REAL, NULL);
+    CRIAR_TAREFA(tarefa_entrada_usuario, "Entrada", 512, 1, NUCLEO_TEMPO_REAL, &tarefa_entrada);
+    inicializar_entradas();
+    CRIAR_TAREFA(tarefa_atualizar_display, "Display", 1024, 1, NUCLEO_TEMPO_REAL, NULL);
+    CRIAR_TAREFA(tarefa_conectar_wifi_mqtt, "WiFi_MQTT", 2048, 3, NUCLEO_REDE, NULL);
+    CRIAR_TAREFA(tarefa_publicar_mqtt, "Publicacao_MQTT", 1024, 1, NUCLEO_REDE, NULL);
+    CRIAR_TAREFA(tarefa_responder_historico, "Historico_MQTT", 512, 1, NUCLEO_REDE, &tarefa_historico);
+    CRIAR_TAREFA(tarefa_drenar_log, "Log", 512, tskIDLE_PRIORITY, NUCLEO_REDE, NULL);
 
     vTaskStartScheduler();
     while (1) tight_loop_contents();